@@ -0,0 +1,74 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <bench/bench.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <pow.h>
+#include <validation.h>
+
+/** Length of the synthetic main chain. */
+static const int CHAIN_LENGTH = 2000000;
+/** Length of the stale fork, which is invalidated and reconsidered. */
+static const int FORK_LENGTH = 10;
+
+static CBlockIndex* AddSyntheticBlock(CBlockIndex* pprev, uint32_t nonce) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    CBlockHeader header;
+    header.hashPrevBlock = pprev ? pprev->GetBlockHash() : uint256();
+    header.nBits = UintToArith256(Params().GetConsensus().powLimit).GetCompact();
+    header.nNonce = nonce;
+
+    CBlockIndex* pindex = new CBlockIndex(header);
+    pindex->phashBlock = &mapBlockIndex.emplace(ArithToUint256(nonce), pindex).first->first;
+    pindex->pprev = pprev;
+    pindex->nHeight = pprev ? pprev->nHeight + 1 : 0;
+    pindex->nChainWork = (pprev ? pprev->nChainWork : 0) + GetBlockProof(*pindex);
+    pindex->RaiseValidity(BLOCK_VALID_TREE);
+    pindex->BuildSkip();
+    setBlockIndexLeaves.erase(pprev);
+    setBlockIndexLeaves.insert(pindex);
+    return pindex;
+}
+
+// Measures invalidating and reconsidering a short stale fork, as done by
+// checkpoint sync for forks which conflict with a checkpoint, on a block
+// index with millions of entries.
+static void InvalidateStaleFork(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const CChainParams& chainparams = Params();
+
+    CBlockIndex* pindexFork;
+    {
+        LOCK(cs_main);
+        uint32_t nonce = 1;
+        CBlockIndex* pindex = AddSyntheticBlock(nullptr, nonce++);
+        CBlockIndex* pindexForkPoint = nullptr;
+        for (int i = 1; i < CHAIN_LENGTH; ++i) {
+            pindex = AddSyntheticBlock(pindex, nonce++);
+            if (i == CHAIN_LENGTH - 2 * FORK_LENGTH) pindexForkPoint = pindex;
+        }
+        chainActive.SetTip(pindex);
+
+        pindexFork = AddSyntheticBlock(pindexForkPoint, nonce++);
+        for (CBlockIndex* pindexWalk = pindexFork; pindexWalk->nHeight < pindexFork->nHeight + FORK_LENGTH - 1;) {
+            pindexWalk = AddSyntheticBlock(pindexWalk, nonce++);
+        }
+    }
+
+    while (state.KeepRunning()) {
+        CValidationState validation_state;
+        bool invalidated{InvalidateBlock(validation_state, chainparams, pindexFork)};
+        assert(invalidated);
+        LOCK(cs_main);
+        ResetBlockFailureFlags(pindexFork);
+    }
+
+    UnloadBlockIndex();
+}
+
+BENCHMARK(InvalidateStaleFork, 2);
@@ -0,0 +1,86 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <coins.h>
+#include <random.h>
+
+#include <unordered_map>
+#include <vector>
+
+/** Number of coins added to the cache before each flush. */
+static const size_t COINS_PER_FLUSH = 50000;
+
+static std::vector<COutPoint> RandomOutpoints()
+{
+    FastRandomContext rng(true);
+    std::vector<COutPoint> outpoints;
+    outpoints.reserve(COINS_PER_FLUSH);
+    for (size_t i = 0; i < COINS_PER_FLUSH; ++i) {
+        outpoints.emplace_back(rng.rand256(), rng.rand32());
+    }
+    return outpoints;
+}
+
+static Coin MakeCoin()
+{
+    Coin coin;
+    coin.out.nValue = COIN;
+    coin.out.scriptPubKey = CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 0) << OP_EQUALVERIFY << OP_CHECKSIG;
+    coin.nHeight = 1;
+    return coin;
+}
+
+typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMallocMap;
+
+template <typename Map>
+static void FillMap(Map& map, const std::vector<COutPoint>& outpoints)
+{
+    for (const COutPoint& outpoint : outpoints) {
+        CCoinsCacheEntry& entry = map[outpoint];
+        entry.coin = MakeCoin();
+        entry.flags = CCoinsCacheEntry::DIRTY | CCoinsCacheEntry::FRESH;
+    }
+}
+
+// Fills the map of a coins cache and drops it, as done by a flush when
+// connecting blocks during IBD or -reindex-chainstate. The nodes come from a
+// pool, which is released at once.
+static void CoinsMapPoolFillFlush(benchmark::State& state)
+{
+    const std::vector<COutPoint> outpoints = RandomOutpoints();
+    while (state.KeepRunning()) {
+        CCoinsMapMemoryResource resource;
+        CCoinsMap map(0, SaltedOutpointHasher(), std::equal_to<COutPoint>(), &resource);
+        FillMap(map, outpoints);
+    }
+}
+
+// The same with a map, which allocates each node with malloc, as a baseline.
+static void CoinsMapMallocFillFlush(benchmark::State& state)
+{
+    const std::vector<COutPoint> outpoints = RandomOutpoints();
+    while (state.KeepRunning()) {
+        CCoinsMallocMap map;
+        FillMap(map, outpoints);
+    }
+}
+
+// A full coins cache, including its accounting, flushed to a dummy view.
+static void CoinsCacheFillFlush(benchmark::State& state)
+{
+    const std::vector<COutPoint> outpoints = RandomOutpoints();
+    CCoinsView base;
+    CCoinsViewCache cache(&base);
+    while (state.KeepRunning()) {
+        for (const COutPoint& outpoint : outpoints) {
+            cache.AddCoin(outpoint, MakeCoin(), false);
+        }
+        cache.Flush();
+    }
+}
+
+BENCHMARK(CoinsMapPoolFillFlush, 10);
+BENCHMARK(CoinsMapMallocFillFlush, 10);
+BENCHMARK(CoinsCacheFillFlush, 10);
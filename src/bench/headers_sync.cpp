@@ -0,0 +1,98 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <pow.h>
+#include <validation.h>
+
+#include <vector>
+
+/** Number of headers messages of MAX_HEADERS_RESULTS headers to sync from genesis. */
+static const unsigned int HEADERS_MESSAGES = 2;
+
+static CBlockHeader MineHeader(const CBlockIndex* pindexPrev, const Consensus::Params& consensusParams)
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashPrevBlock = pindexPrev->GetBlockHash();
+    header.hashMerkleRoot = pindexPrev->GetBlockHash();
+    header.nTime = pindexPrev->GetBlockTime() + consensusParams.nPowTargetSpacing;
+    header.nBits = GetNextWorkRequired(pindexPrev, &header, consensusParams);
+    header.nNonce = 0;
+
+    const unsigned int profile = header.GetBlockTime() >= consensusParams.nNeoScryptFork ? 0x0 : 0x3;
+    while (!CheckProofOfWork(header.GetPoWHash(profile), header.nBits, consensusParams)) {
+        ++header.nNonce;
+        assert(header.nNonce);
+    }
+    return header;
+}
+
+/** Mine a chain of headers, adding them to the block index one by one to get the difficulty of each from GetNextWorkRequired. */
+static std::vector<CBlockHeader> MineHeaders(const CChainParams& chainparams)
+{
+    std::vector<CBlockHeader> headers;
+    CValidationState validation_state;
+    const CBlockIndex* pindex = nullptr;
+    bool processed{ProcessNewBlockHeaders({chainparams.GenesisBlock().GetBlockHeader()}, validation_state, chainparams, &pindex)};
+    assert(processed);
+    while (headers.size() < HEADERS_MESSAGES * MAX_HEADERS_RESULTS) {
+        headers.push_back(MineHeader(pindex, chainparams.GetConsensus()));
+        processed = ProcessNewBlockHeaders({headers.back()}, validation_state, chainparams, &pindex);
+        assert(processed);
+    }
+    UnloadBlockIndex();
+    return headers;
+}
+
+static void ProcessHeadersMessages(const std::vector<CBlockHeader>& headers, const CChainParams& chainparams)
+{
+    CValidationState validation_state;
+    for (auto it = headers.begin(); it != headers.end(); it += MAX_HEADERS_RESULTS) {
+        const std::vector<CBlockHeader> message(it, it + MAX_HEADERS_RESULTS);
+        bool processed{ProcessNewBlockHeaders(message, validation_state, chainparams)};
+        assert(processed);
+    }
+}
+
+// Measures the wall time of a header sync from genesis, as done for a peer
+// that serves full headers messages.
+static void HeadersSync(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const CChainParams& chainparams = Params();
+    const std::vector<CBlockHeader> headers = MineHeaders(chainparams);
+
+    while (state.KeepRunning()) {
+        CValidationState validation_state;
+        bool processed{ProcessNewBlockHeaders({chainparams.GenesisBlock().GetBlockHeader()}, validation_state, chainparams)};
+        assert(processed);
+        ProcessHeadersMessages(headers, chainparams);
+        UnloadBlockIndex();
+    }
+}
+
+// Measures processing headers messages, which only contain known headers, as
+// sent again by the same peer or by other peers announcing the same chain.
+static void HeadersResend(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const CChainParams& chainparams = Params();
+    const std::vector<CBlockHeader> headers = MineHeaders(chainparams);
+
+    CValidationState validation_state;
+    bool processed{ProcessNewBlockHeaders({chainparams.GenesisBlock().GetBlockHeader()}, validation_state, chainparams)};
+    assert(processed);
+    ProcessHeadersMessages(headers, chainparams);
+
+    while (state.KeepRunning()) {
+        ProcessHeadersMessages(headers, chainparams);
+    }
+    UnloadBlockIndex();
+}
+
+BENCHMARK(HeadersSync, 1);
+BENCHMARK(HeadersResend, 1);
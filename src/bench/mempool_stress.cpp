@@ -0,0 +1,151 @@
+// Copyright (c) 2011-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <policy/policy.h>
+#include <random.h>
+#include <txmempool.h>
+
+#include <vector>
+
+static void AddTx(const CTransactionRef& tx, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
+{
+    int64_t nTime = 0;
+    unsigned int nHeight = 1;
+    bool spendsCoinbase = false;
+    unsigned int sigOpCost = 4;
+    LockPoints lp;
+    pool.addUnchecked(CTxMemPoolEntry(tx, 1000, nTime, nHeight, spendsCoinbase, sigOpCost, lp));
+}
+
+struct Available {
+    CTransactionRef ref;
+    size_t vin_left{0};
+    size_t tx_count;
+    Available(CTransactionRef& ref, size_t tx_count) : ref(ref), tx_count(tx_count){}
+};
+
+/**
+ * Creates packages of transactions close to the default ancestor and
+ * descendant limits. Each transaction spends one or two unspent outputs of
+ * earlier transactions of its package, so that every package forms a dense
+ * graph with long chains rather than a flat fan-out. The transactions are
+ * returned in topological order.
+ */
+static std::vector<CTransactionRef> CreatePackages(size_t n_packages, size_t package_size)
+{
+    FastRandomContext det_rand{true};
+    std::vector<CTransactionRef> ordered_coins;
+    for (size_t package = 0; package < n_packages; ++package) {
+        std::vector<Available> available_coins;
+        for (size_t i = 0; i < package_size; ++i) {
+            CMutableTransaction tx = CMutableTransaction();
+            if (available_coins.empty()) {
+                // A fresh package root, spending a (fake) confirmed output
+                tx.vin.resize(1);
+                tx.vin[0].prevout = COutPoint(uint256(det_rand.randbytes(32)), 0);
+                tx.vin[0].scriptSig = CScript() << CScriptNum(package);
+            } else {
+                const size_t n_inputs = std::min<size_t>(available_coins.size(), 1 + det_rand.randrange(2));
+                for (size_t in = 0; in < n_inputs; ++in) {
+                    const size_t idx = available_coins.size() - 1 - det_rand.randrange(std::min<size_t>(available_coins.size(), 3));
+                    Available& coin = available_coins[idx];
+                    tx.vin.emplace_back(COutPoint(coin.ref->GetHash(), coin.vin_left++));
+                    tx.vin.back().scriptSig = CScript() << coin.tx_count;
+                    if (coin.vin_left == coin.ref->vout.size()) {
+                        available_coins.erase(available_coins.begin() + idx);
+                    }
+                }
+            }
+            tx.vout.resize(2);
+            for (auto& out : tx.vout) {
+                out.scriptPubKey = CScript() << CScriptNum(i) << OP_EQUAL;
+                out.nValue = 10 * COIN;
+            }
+            ordered_coins.emplace_back(MakeTransactionRef(tx));
+            available_coins.emplace_back(ordered_coins.back(), i);
+        }
+    }
+    return ordered_coins;
+}
+
+static const size_t PACKAGE_COUNT = 40;
+static const size_t PACKAGE_SIZE = 25;
+
+static void MempoolAncestorsDescendants(benchmark::State& state)
+{
+    const std::vector<CTransactionRef> ordered_coins = CreatePackages(PACKAGE_COUNT, PACKAGE_SIZE);
+    CTxMemPool pool;
+    LOCK2(cs_main, pool.cs);
+    for (const auto& tx : ordered_coins) {
+        AddTx(tx, pool);
+    }
+    std::string dummy;
+    while (state.KeepRunning()) {
+        for (const auto& tx : ordered_coins) {
+            CTxMemPool::txiter it = pool.mapTx.find(tx->GetHash());
+            CTxMemPool::setEntries ancestors, descendants;
+            pool.CalculateMemPoolAncestors(*it, ancestors, PACKAGE_SIZE, 1000000000, PACKAGE_SIZE, 1000000000, dummy, false);
+            pool.CalculateDescendants(it, descendants);
+        }
+    }
+}
+
+static void MempoolRemoveRecursive(benchmark::State& state)
+{
+    const std::vector<CTransactionRef> ordered_coins = CreatePackages(PACKAGE_COUNT, PACKAGE_SIZE);
+    CTxMemPool pool;
+    LOCK2(cs_main, pool.cs);
+    while (state.KeepRunning()) {
+        for (const auto& tx : ordered_coins) {
+            AddTx(tx, pool);
+        }
+        // Removing each package root evicts the whole package
+        for (size_t i = 0; i < ordered_coins.size(); i += PACKAGE_SIZE) {
+            pool.removeRecursive(*ordered_coins[i]);
+        }
+        assert(pool.size() == 0);
+    }
+}
+
+static void MempoolRemoveForBlock(benchmark::State& state)
+{
+    const std::vector<CTransactionRef> ordered_coins = CreatePackages(PACKAGE_COUNT, PACKAGE_SIZE);
+    CTxMemPool pool;
+    LOCK2(cs_main, pool.cs);
+    while (state.KeepRunning()) {
+        for (const auto& tx : ordered_coins) {
+            AddTx(tx, pool);
+        }
+        pool.removeForBlock(ordered_coins, 2);
+        assert(pool.size() == 0);
+    }
+}
+
+static void MempoolRemoveForBlockConflicts(benchmark::State& state)
+{
+    const std::vector<CTransactionRef> ordered_coins = CreatePackages(PACKAGE_COUNT, PACKAGE_SIZE);
+    // A block double spending the input of every package root, so that all
+    // packages are removed as conflicts.
+    std::vector<CTransactionRef> block_txs;
+    for (size_t i = 0; i < ordered_coins.size(); i += PACKAGE_SIZE) {
+        CMutableTransaction tx = CMutableTransaction(*ordered_coins[i]);
+        tx.vout[0].nValue -= 1;
+        block_txs.emplace_back(MakeTransactionRef(tx));
+    }
+    CTxMemPool pool;
+    LOCK2(cs_main, pool.cs);
+    while (state.KeepRunning()) {
+        for (const auto& tx : ordered_coins) {
+            AddTx(tx, pool);
+        }
+        pool.removeForBlock(block_txs, 2);
+        assert(pool.size() == 0);
+    }
+}
+
+BENCHMARK(MempoolAncestorsDescendants, 5);
+BENCHMARK(MempoolRemoveRecursive, 5);
+BENCHMARK(MempoolRemoveForBlock, 5);
+BENCHMARK(MempoolRemoveForBlockConflicts, 5);
@@ -0,0 +1,66 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockcache.h>
+
+CBlockCache g_block_cache;
+
+void CBlockCache::Trim()
+{
+    AssertLockHeld(m_mutex);
+    while (m_blocks.size() > m_max_size) {
+        m_index.erase(m_blocks.back().first);
+        m_blocks.pop_back();
+    }
+}
+
+void CBlockCache::SetMaxSize(size_t max_size)
+{
+    LOCK(m_mutex);
+    m_max_size = max_size;
+    Trim();
+}
+
+void CBlockCache::Insert(const uint256& hash, std::shared_ptr<const CBlock> block)
+{
+    LOCK(m_mutex);
+    if (m_max_size == 0) return;
+
+    auto it = m_index.find(hash);
+    if (it != m_index.end()) {
+        m_blocks.splice(m_blocks.begin(), m_blocks, it->second);
+        return;
+    }
+    m_blocks.emplace_front(hash, std::move(block));
+    m_index.emplace(hash, m_blocks.begin());
+    Trim();
+}
+
+std::shared_ptr<const CBlock> CBlockCache::Get(const uint256& hash)
+{
+    LOCK(m_mutex);
+    if (m_max_size == 0) return nullptr;
+
+    auto it = m_index.find(hash);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    m_blocks.splice(m_blocks.begin(), m_blocks, it->second);
+    return it->second->second;
+}
+
+void CBlockCache::Clear()
+{
+    LOCK(m_mutex);
+    m_blocks.clear();
+    m_index.clear();
+}
+
+CBlockCache::Stats CBlockCache::GetStats() const
+{
+    LOCK(m_mutex);
+    return Stats{m_blocks.size(), m_max_size, m_hits, m_misses};
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKCACHE_H
+#define BITCOIN_BLOCKCACHE_H
+
+#include <crypto/common.h>
+#include <primitives/block.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+/** Default for -blockcachesize, the number of recently connected blocks kept in memory */
+static const unsigned int DEFAULT_BLOCK_CACHE_SIZE = 10;
+
+/**
+ * Cache of recently connected blocks, keyed by block hash.
+ *
+ * Right after a block is connected, it is walked by the wallet, the indexes,
+ * Omni Core, and fetched by REST and RPC clients. The cache serves these
+ * reads from memory instead of reading, deserializing and hashing the block
+ * from disk again. The least recently used block is evicted first.
+ */
+class CBlockCache
+{
+public:
+    struct Stats
+    {
+        size_t size;
+        size_t max_size;
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+private:
+    struct Hasher
+    {
+        size_t operator()(const uint256& hash) const { return ReadLE64(hash.begin()); }
+    };
+
+    using BlockList = std::list<std::pair<uint256, std::shared_ptr<const CBlock>>>;
+
+    mutable Mutex m_mutex;
+    size_t m_max_size GUARDED_BY(m_mutex);
+    //! Cached blocks, most recently used first
+    BlockList m_blocks GUARDED_BY(m_mutex);
+    std::unordered_map<uint256, BlockList::iterator, Hasher> m_index GUARDED_BY(m_mutex);
+    uint64_t m_hits GUARDED_BY(m_mutex) = 0;
+    uint64_t m_misses GUARDED_BY(m_mutex) = 0;
+
+    void Trim() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+public:
+    explicit CBlockCache(size_t max_size = DEFAULT_BLOCK_CACHE_SIZE) : m_max_size(max_size) {}
+
+    /** Change the number of blocks kept, 0 disables the cache. */
+    void SetMaxSize(size_t max_size);
+
+    /** Add a block, or mark it as most recently used if it is cached already. */
+    void Insert(const uint256& hash, std::shared_ptr<const CBlock> block);
+
+    /** Look up a block. Returns null if it is not cached. */
+    std::shared_ptr<const CBlock> Get(const uint256& hash);
+
+    void Clear();
+
+    Stats GetStats() const;
+};
+
+/** The cache of recently connected blocks, consulted by ReadBlockFromDisk. */
+extern CBlockCache g_block_cache;
+
+#endif // BITCOIN_BLOCKCACHE_H
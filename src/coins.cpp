@@ -6,12 +6,15 @@
 
 #include <consensus/consensus.h>
 #include <random.h>
+#include <streams.h>
+#include <util/memory.h>
 #include <version.h>
 
 bool CCoinsView::GetCoin(const COutPoint &outpoint, Coin &coin) const { return false; }
 uint256 CCoinsView::GetBestBlock() const { return uint256(); }
 std::vector<uint256> CCoinsView::GetHeadBlocks() const { return std::vector<uint256>(); }
-bool CCoinsView::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) { return false; }
+bool CCoinsView::GetStats(CCoinsSetStats &stats) const { return false; }
+bool CCoinsView::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CCoinsSetStats &statsDelta) { return false; }
 CCoinsViewCursor *CCoinsView::Cursor() const { return nullptr; }
 
 bool CCoinsView::HaveCoin(const COutPoint &outpoint) const
@@ -25,14 +28,73 @@ bool CCoinsViewBacked::GetCoin(const COutPoint &outpoint, Coin &coin) const { re
 bool CCoinsViewBacked::HaveCoin(const COutPoint &outpoint) const { return base->HaveCoin(outpoint); }
 uint256 CCoinsViewBacked::GetBestBlock() const { return base->GetBestBlock(); }
 std::vector<uint256> CCoinsViewBacked::GetHeadBlocks() const { return base->GetHeadBlocks(); }
+bool CCoinsViewBacked::GetStats(CCoinsSetStats &stats) const { return base->GetStats(stats); }
 void CCoinsViewBacked::SetBackend(CCoinsView &viewIn) { base = &viewIn; }
-bool CCoinsViewBacked::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) { return base->BatchWrite(mapCoins, hashBlock); }
+bool CCoinsViewBacked::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CCoinsSetStats &statsDelta) { return base->BatchWrite(mapCoins, hashBlock, statsDelta); }
 CCoinsViewCursor *CCoinsViewBacked::Cursor() const { return base->Cursor(); }
 size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
 
+static void TxOutSer(std::vector<unsigned char>& vch, const COutPoint& outpoint, const Coin& coin)
+{
+    CVectorWriter ss(SER_DISK, PROTOCOL_VERSION, vch, 0);
+    ss << outpoint;
+    ss << static_cast<uint32_t>(coin.nHeight * 2 + coin.fCoinBase);
+    ss << coin.out;
+}
+
+static int64_t BogoSize(const Coin& coin)
+{
+    return 32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
+           2 /* scriptPubKey len */ + coin.out.scriptPubKey.size() /* scriptPubKey */;
+}
+
+void CCoinsSetStats::AddCoin(const COutPoint& outpoint, const Coin& coin)
+{
+    std::vector<unsigned char> vch;
+    TxOutSer(vch, outpoint, coin);
+    muhash.Insert(Span<const unsigned char>(vch.data(), vch.size()));
+    nTransactionOutputs++;
+    nBogoSize += BogoSize(coin);
+    nTotalAmount += coin.out.nValue;
+}
+
+void CCoinsSetStats::RemoveCoin(const COutPoint& outpoint, const Coin& coin)
+{
+    std::vector<unsigned char> vch;
+    TxOutSer(vch, outpoint, coin);
+    muhash.Remove(Span<const unsigned char>(vch.data(), vch.size()));
+    nTransactionOutputs--;
+    nBogoSize -= BogoSize(coin);
+    nTotalAmount -= coin.out.nValue;
+}
+
+CCoinsSetStats& CCoinsSetStats::operator+=(const CCoinsSetStats& other)
+{
+    muhash *= other.muhash;
+    nTransactionOutputs += other.nTransactionOutputs;
+    nBogoSize += other.nBogoSize;
+    nTotalAmount += other.nTotalAmount;
+    return *this;
+}
+
 SaltedOutpointHasher::SaltedOutpointHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
 
-CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn), cachedCoinsUsage(0) {}
+SaltedScriptHasher::SaltedScriptHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn),
+    cacheCoinsMemoryResource(MakeUnique<CCoinsMapMemoryResource>()),
+    cacheCoins(0, SaltedOutpointHasher(), std::equal_to<COutPoint>(), cacheCoinsMemoryResource.get()), cachedCoinsUsage(0) {}
+
+void CCoinsViewCache::Swap(CCoinsViewCache& other)
+{
+    // The maps take their allocators, and thus their pools, along
+    std::swap(base, other.base);
+    std::swap(hashBlock, other.hashBlock);
+    std::swap(cacheCoinsMemoryResource, other.cacheCoinsMemoryResource);
+    cacheCoins.swap(other.cacheCoins);
+    std::swap(cachedCoinsUsage, other.cachedCoinsUsage);
+    std::swap(cacheStatsDelta, other.cacheStatsDelta);
+}
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
     return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
@@ -73,6 +135,12 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
     bool fresh = false;
     if (!inserted) {
         cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+        // An overwritten coin leaves the set. Overwrites of coins, which are
+        // not loaded into this cache, are not accounted for, which only
+        // affects the historic duplicate coinbase transactions.
+        if (possible_overwrite && !it->second.coin.IsSpent()) {
+            cacheStatsDelta.RemoveCoin(outpoint, it->second.coin);
+        }
     }
     if (!possible_overwrite) {
         if (!it->second.coin.IsSpent()) {
@@ -80,6 +148,7 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
         }
         fresh = !(it->second.flags & CCoinsCacheEntry::DIRTY);
     }
+    cacheStatsDelta.AddCoin(outpoint, coin);
     it->second.coin = std::move(coin);
     it->second.flags |= CCoinsCacheEntry::DIRTY | (fresh ? CCoinsCacheEntry::FRESH : 0);
     cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
@@ -100,6 +169,9 @@ bool CCoinsViewCache::SpendCoin(const COutPoint &outpoint, Coin* moveout) {
     CCoinsMap::iterator it = FetchCoin(outpoint);
     if (it == cacheCoins.end()) return false;
     cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+    if (!it->second.coin.IsSpent()) {
+        cacheStatsDelta.RemoveCoin(outpoint, it->second.coin);
+    }
     if (moveout) {
         *moveout = std::move(it->second.coin);
     }
@@ -143,7 +215,13 @@ void CCoinsViewCache::SetBestBlock(const uint256 &hashBlockIn) {
     hashBlock = hashBlockIn;
 }
 
-bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlockIn) {
+bool CCoinsViewCache::GetStats(CCoinsSetStats &stats) const {
+    if (!base->GetStats(stats)) return false;
+    stats += cacheStatsDelta;
+    return true;
+}
+
+bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlockIn, const CCoinsSetStats &statsDelta) {
     for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end(); it = mapCoins.erase(it)) {
         // Ignore non-dirty entries (optimization).
         if (!(it->second.flags & CCoinsCacheEntry::DIRTY)) {
@@ -198,16 +276,29 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlockIn
         }
     }
     hashBlock = hashBlockIn;
+    cacheStatsDelta += statsDelta;
     return true;
 }
 
 bool CCoinsViewCache::Flush() {
-    bool fOk = base->BatchWrite(cacheCoins, hashBlock);
+    bool fOk = base->BatchWrite(cacheCoins, hashBlock, cacheStatsDelta);
     cacheCoins.clear();
     cachedCoinsUsage = 0;
+    cacheStatsDelta = CCoinsSetStats();
+    ReallocateCache();
     return fOk;
 }
 
+void CCoinsViewCache::ReallocateCache()
+{
+    // Destroying the map only returns its nodes to the pool, destroying the
+    // pool releases all chunks at once.
+    assert(cacheCoins.size() == 0);
+    cacheCoins.~CCoinsMap();
+    cacheCoinsMemoryResource = MakeUnique<CCoinsMapMemoryResource>();
+    ::new (&cacheCoins) CCoinsMap(0, SaltedOutpointHasher(), std::equal_to<COutPoint>(), cacheCoinsMemoryResource.get());
+}
+
 void CCoinsViewCache::Uncache(const COutPoint& hash)
 {
     CCoinsMap::iterator it = cacheCoins.find(hash);
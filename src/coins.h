@@ -9,14 +9,18 @@
 #include <primitives/transaction.h>
 #include <compressor.h>
 #include <core_memusage.h>
+#include <crypto/muhash.h>
 #include <crypto/siphash.h>
 #include <memusage.h>
 #include <serialize.h>
+#include <support/allocators/pool.h>
 #include <uint256.h>
 
 #include <assert.h>
 #include <stdint.h>
 
+#include <functional>
+#include <memory>
 #include <unordered_map>
 
 struct CSpentIndexKey {
@@ -173,6 +177,20 @@ public:
     }
 };
 
+class SaltedScriptHasher
+{
+private:
+    /** Salt */
+    uint64_t k0, k1;
+
+public:
+    SaltedScriptHasher();
+
+    size_t operator()(const CScript& script) const {
+        return CSipHasher(k0, k1).Write(script.data(), script.size()).Finalize();
+    }
+};
+
 struct CCoinsCacheEntry
 {
     Coin coin; // The actual cached data.
@@ -192,7 +210,54 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+/**
+ * The nodes of CCoinsMap are allocated from a pool, which avoids the malloc
+ * overhead per cached coin. The node layout of std::unordered_map is
+ * implementation defined, but adds at most a few pointers (the next pointer
+ * and possibly the cached hash) to the value, so leave room for 4 of them.
+ */
+typedef PoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>,
+                      sizeof(std::pair<const COutPoint, CCoinsCacheEntry>) + sizeof(void*) * 4,
+                      alignof(void*)>
+    CCoinsMapAllocator;
+
+typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher, std::equal_to<COutPoint>, CCoinsMapAllocator> CCoinsMap;
+
+typedef CCoinsMapAllocator::ResourceType CCoinsMapMemoryResource;
+
+/**
+ * Order-independent hash and running totals of a set of unspent outputs.
+ *
+ * Coins can be added and removed in any order, and two instances can be
+ * merged, so the same type is used both for the statistics of a whole coins
+ * database and for the changes a cache applies on top of its base view.
+ */
+class CCoinsSetStats
+{
+public:
+    MuHash3072 muhash;
+    int64_t nTransactionOutputs;
+    int64_t nBogoSize;
+    CAmount nTotalAmount;
+
+    CCoinsSetStats() : nTransactionOutputs(0), nBogoSize(0), nTotalAmount(0) {}
+
+    void AddCoin(const COutPoint& outpoint, const Coin& coin);
+    void RemoveCoin(const COutPoint& outpoint, const Coin& coin);
+
+    //! Applies the changes tracked by another instance
+    CCoinsSetStats& operator+=(const CCoinsSetStats& other);
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(muhash);
+        READWRITE(nTransactionOutputs);
+        READWRITE(nBogoSize);
+        READWRITE(nTotalAmount);
+    }
+};
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -236,9 +301,14 @@ public:
     //! the old block hash, in that order.
     virtual std::vector<uint256> GetHeadBlocks() const;
 
+    //! Retrieve the statistics of the whole coins set this CCoinsView represents.
+    //! Returns false if they are not known.
+    virtual bool GetStats(CCoinsSetStats &stats) const;
+
     //! Do a bulk modification (multiple Coin changes + BestBlock change).
-    //! The passed mapCoins can be modified.
-    virtual bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock);
+    //! The passed mapCoins can be modified. statsDelta holds the changes
+    //! of the coins set statistics caused by these modifications.
+    virtual bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CCoinsSetStats &statsDelta);
 
     //! Get a cursor to iterate over the whole state
     virtual CCoinsViewCursor *Cursor() const;
@@ -263,8 +333,9 @@ public:
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     std::vector<uint256> GetHeadBlocks() const override;
+    bool GetStats(CCoinsSetStats &stats) const override;
     void SetBackend(CCoinsView &viewIn);
-    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CCoinsSetStats &statsDelta) override;
     CCoinsViewCursor *Cursor() const override;
     size_t EstimateSize() const override;
 };
@@ -279,20 +350,35 @@ protected:
      * declared as "const".
      */
     mutable uint256 hashBlock;
+    /* Pool the nodes of cacheCoins are allocated from, must be declared before it. */
+    std::unique_ptr<CCoinsMapMemoryResource> cacheCoinsMemoryResource;
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
     mutable size_t cachedCoinsUsage;
 
+    /* Changes of the coins set statistics, which are not yet flushed to the base. */
+    CCoinsSetStats cacheStatsDelta;
+
 public:
     CCoinsViewCache(CCoinsView *baseIn);
 
+    /**
+     * By deleting the copy constructor, we prevent accidentally using it when one intends to create a cache on top of a base cache.
+     */
+    CCoinsViewCache(const CCoinsViewCache &) = delete;
+    CCoinsViewCache& operator=(const CCoinsViewCache &) = delete;
+
+    //! Exchange the state of two caches, including their base views
+    void Swap(CCoinsViewCache& other);
+
     // Standard CCoinsView methods
     bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     void SetBestBlock(const uint256 &hashBlock);
-    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    bool GetStats(CCoinsSetStats &stats) const override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CCoinsSetStats &statsDelta) override;
     CCoinsViewCursor* Cursor() const override {
         throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
     }
@@ -348,6 +434,9 @@ public:
     //! Calculate the size of the cache (in bytes)
     size_t DynamicMemoryUsage() const;
 
+    //! Give the memory of the empty cache back to the system, as the pool only grows otherwise
+    void ReallocateCache();
+
     /**
      * Amount of bitcoins coming in to a transaction
      * Note that lightweight clients may not know anything besides the hash of previous transactions,
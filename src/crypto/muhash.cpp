@@ -0,0 +1,182 @@
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/muhash.h>
+
+#include <crypto/chacha20.h>
+#include <crypto/common.h>
+#include <crypto/sha256.h>
+
+#include <limits>
+
+namespace {
+
+typedef Num3072::limb_t limb_t;
+typedef Num3072::double_limb_t double_limb_t;
+constexpr int LIMB_SIZE = Num3072::LIMB_SIZE;
+constexpr int LIMBS = Num3072::LIMBS;
+/** 2^3072 - 1103717, the largest 3072-bit safe prime number, is used as the modulus. */
+constexpr limb_t MAX_PRIME_DIFF = 1103717;
+
+/** Adds n * 2^(LIMB_SIZE * start) to the number in limbs, returns the carry out of the top limb. */
+inline limb_t AddAt(limb_t (&limbs)[LIMBS], double_limb_t n, int start)
+{
+    for (int i = start; i < LIMBS && n != 0; ++i) {
+        n += limbs[i];
+        limbs[i] = (limb_t)n;
+        n >>= LIMB_SIZE;
+    }
+    return (limb_t)n;
+}
+
+} // namespace
+
+Num3072::Num3072()
+{
+    SetToOne();
+}
+
+Num3072::Num3072(const unsigned char (&data)[BYTE_SIZE])
+{
+    for (int i = 0; i < LIMBS; ++i) {
+        if (sizeof(limb_t) == 4) {
+            limbs[i] = ReadLE32(data + 4 * i);
+        } else {
+            limbs[i] = ReadLE64(data + 8 * i);
+        }
+    }
+    if (IsOverflow()) FullReduce();
+}
+
+void Num3072::ToBytes(unsigned char (&out)[BYTE_SIZE]) const
+{
+    for (int i = 0; i < LIMBS; ++i) {
+        if (sizeof(limb_t) == 4) {
+            WriteLE32(out + 4 * i, limbs[i]);
+        } else {
+            WriteLE64(out + 8 * i, limbs[i]);
+        }
+    }
+}
+
+void Num3072::SetToOne()
+{
+    limbs[0] = 1;
+    for (int i = 1; i < LIMBS; ++i) limbs[i] = 0;
+}
+
+/** Indicates whether the number is not smaller than the modulus. */
+bool Num3072::IsOverflow() const
+{
+    if (limbs[0] <= std::numeric_limits<limb_t>::max() - MAX_PRIME_DIFF) return false;
+    for (int i = 1; i < LIMBS; ++i) {
+        if (limbs[i] != std::numeric_limits<limb_t>::max()) return false;
+    }
+    return true;
+}
+
+/** Subtracts the modulus, i.e. adds 2^3072 - modulus and drops the carry. */
+void Num3072::FullReduce()
+{
+    AddAt(limbs, MAX_PRIME_DIFF, 0);
+}
+
+void Num3072::Multiply(const Num3072& a)
+{
+    // Schoolbook multiplication into a 6144-bit product.
+    limb_t product[2 * LIMBS] = {0};
+    for (int i = 0; i < LIMBS; ++i) {
+        limb_t carry = 0;
+        for (int j = 0; j < LIMBS; ++j) {
+            double_limb_t t = (double_limb_t)limbs[i] * a.limbs[j] + product[i + j] + carry;
+            product[i + j] = (limb_t)t;
+            carry = t >> LIMB_SIZE;
+        }
+        product[i + LIMBS] = carry;
+    }
+
+    // As 2^3072 = MAX_PRIME_DIFF (mod p), the high half is folded into the
+    // low half multiplied by MAX_PRIME_DIFF.
+    limb_t carry = 0;
+    for (int i = 0; i < LIMBS; ++i) {
+        double_limb_t t = (double_limb_t)product[LIMBS + i] * MAX_PRIME_DIFF + product[i] + carry;
+        limbs[i] = (limb_t)t;
+        carry = t >> LIMB_SIZE;
+    }
+
+    // Fold the remaining carry until the number fits into 3072 bits.
+    while (carry != 0) {
+        carry = AddAt(limbs, (double_limb_t)carry * MAX_PRIME_DIFF, 0);
+    }
+    if (IsOverflow()) FullReduce();
+}
+
+/** Calculates the inverse as a^(p - 2) (mod p), using Fermat's little theorem. */
+Num3072 Num3072::GetInverse() const
+{
+    // p - 2 = 2^3072 - 1103719: all bits are set, except some in the lowest limb.
+    const limb_t lowest = std::numeric_limits<limb_t>::max() - (MAX_PRIME_DIFF + 1);
+
+    Num3072 out;
+    for (int i = LIMBS - 1; i >= 0; --i) {
+        const limb_t exponent = (i == 0) ? lowest : std::numeric_limits<limb_t>::max();
+        for (int bit = LIMB_SIZE - 1; bit >= 0; --bit) {
+            out.Multiply(out);
+            if ((exponent >> bit) & 1) out.Multiply(*this);
+        }
+    }
+    return out;
+}
+
+void Num3072::Divide(const Num3072& a)
+{
+    Multiply(a.GetInverse());
+}
+
+Num3072 MuHash3072::ToNum3072(Span<const unsigned char> in)
+{
+    unsigned char hashed_in[CSHA256::OUTPUT_SIZE];
+    CSHA256().Write(in.data(), in.size()).Finalize(hashed_in);
+
+    unsigned char tmp[Num3072::BYTE_SIZE];
+    ChaCha20(hashed_in, sizeof(hashed_in)).Output(tmp, sizeof(tmp));
+    return Num3072(tmp);
+}
+
+MuHash3072& MuHash3072::Insert(Span<const unsigned char> in) noexcept
+{
+    m_numerator.Multiply(ToNum3072(in));
+    return *this;
+}
+
+MuHash3072& MuHash3072::Remove(Span<const unsigned char> in) noexcept
+{
+    m_denominator.Multiply(ToNum3072(in));
+    return *this;
+}
+
+MuHash3072& MuHash3072::operator*=(const MuHash3072& mul) noexcept
+{
+    m_numerator.Multiply(mul.m_numerator);
+    m_denominator.Multiply(mul.m_denominator);
+    return *this;
+}
+
+MuHash3072& MuHash3072::operator/=(const MuHash3072& div) noexcept
+{
+    m_numerator.Multiply(div.m_denominator);
+    m_denominator.Multiply(div.m_numerator);
+    return *this;
+}
+
+void MuHash3072::Finalize(uint256& out) noexcept
+{
+    m_numerator.Divide(m_denominator);
+    m_denominator.SetToOne(); // Needed to keep the MuHash object valid
+
+    unsigned char data[Num3072::BYTE_SIZE];
+    m_numerator.ToBytes(data);
+
+    CSHA256().Write(data, sizeof(data)).Finalize(out.begin());
+}
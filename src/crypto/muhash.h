@@ -0,0 +1,111 @@
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_MUHASH_H
+#define BITCOIN_CRYPTO_MUHASH_H
+
+#include <serialize.h>
+#include <span.h>
+#include <uint256.h>
+
+#include <stdint.h>
+
+/** A 3072-bit number, kept reduced modulo the prime 2^3072 - 1103717. */
+class Num3072
+{
+public:
+#ifdef __SIZEOF_INT128__
+    typedef unsigned __int128 double_limb_t;
+    typedef uint64_t limb_t;
+    static constexpr int LIMBS = 48;
+    static constexpr int LIMB_SIZE = 64;
+#else
+    typedef uint64_t double_limb_t;
+    typedef uint32_t limb_t;
+    static constexpr int LIMBS = 96;
+    static constexpr int LIMB_SIZE = 32;
+#endif
+    static constexpr size_t BYTE_SIZE = 384;
+
+    limb_t limbs[LIMBS];
+
+    //! Constructs the number one.
+    Num3072();
+    //! Constructs a number from its 384 byte little-endian encoding.
+    explicit Num3072(const unsigned char (&data)[BYTE_SIZE]);
+
+    void SetToOne();
+    void Multiply(const Num3072& a);
+    void Divide(const Num3072& a);
+    void ToBytes(unsigned char (&out)[BYTE_SIZE]) const;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        for (int i = 0; i < LIMBS; ++i) {
+            READWRITE(limbs[i]);
+        }
+    }
+
+private:
+    bool IsOverflow() const;
+    void FullReduce();
+    Num3072 GetInverse() const;
+};
+
+/** A class representing MuHash sets
+ *
+ * MuHash is a hashing algorithm that supports adding set elements in any
+ * order but also deleting in any order. As a result, it can maintain a
+ * running sum for a set of data as a whole, and add/remove when data
+ * is added to or removed from it. A downside of MuHash is that computing
+ * an inverse is relatively expensive. This is solved by keeping a running
+ * numerator and denominator, which are only divided in Finalize().
+ *
+ * Each element is hashed with SHA256 and expanded to 3072 bits using
+ * ChaCha20, and the set is represented by the product of its elements
+ * modulo 2^3072 - 1103717. The final result is the SHA256 hash of the
+ * 384 byte little-endian encoding of numerator / denominator.
+ *
+ * For the security of MuHash, see "A New Paradigm for Collision-free
+ * Hashing: Incrementality at Reduced Cost" (Bellare, Micciancio, 1997).
+ */
+class MuHash3072
+{
+private:
+    Num3072 m_numerator;
+    Num3072 m_denominator;
+
+    static Num3072 ToNum3072(Span<const unsigned char> in);
+
+public:
+    /** Constructs the hash of the empty set. */
+    MuHash3072() noexcept {}
+
+    /** Adds an element to the set. */
+    MuHash3072& Insert(Span<const unsigned char> in) noexcept;
+
+    /** Removes an element from the set. */
+    MuHash3072& Remove(Span<const unsigned char> in) noexcept;
+
+    /** Multiplies with another set, i.e. merges the changes of another set. */
+    MuHash3072& operator*=(const MuHash3072& mul) noexcept;
+
+    /** Divides by another set, i.e. reverts the changes of another set. */
+    MuHash3072& operator/=(const MuHash3072& div) noexcept;
+
+    /** Finalizes the computation and returns the hash of the set. */
+    void Finalize(uint256& out) noexcept;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(m_numerator);
+        READWRITE(m_denominator);
+    }
+};
+
+#endif // BITCOIN_CRYPTO_MUHASH_H
@@ -6,15 +6,23 @@
 #include <index/base.h>
 #include <shutdown.h>
 #include <tinyformat.h>
+#include <txdb.h>
 #include <ui_interface.h>
 #include <util/system.h>
 #include <validation.h>
 #include <warnings.h>
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
 constexpr char DB_BEST_BLOCK = 'B';
 
 constexpr int64_t SYNC_LOG_INTERVAL = 30; // seconds
 constexpr int64_t SYNC_LOCATOR_WRITE_INTERVAL = 30; // seconds
+constexpr size_t SYNC_PREFETCH_BLOCKS = 32;
+constexpr int MAX_SYNC_READ_THREADS = 4;
 
 template<typename... Args>
 static void FatalError(const char* fmt, const Args&... args)
@@ -46,6 +54,11 @@ bool BaseIndex::DB::WriteBestBlock(const CBlockLocator& locator)
     return Write(DB_BEST_BLOCK, locator);
 }
 
+void BaseIndex::DB::WriteBestBlock(CDBBatch& batch, const CBlockLocator& locator)
+{
+    batch.Write(DB_BEST_BLOCK, locator);
+}
+
 BaseIndex::~BaseIndex()
 {
     Interrupt();
@@ -85,55 +98,182 @@ static const CBlockIndex* NextSyncBlock(const CBlockIndex* pindex_prev) EXCLUSIV
     return chainActive.Next(chainActive.FindFork(pindex_prev));
 }
 
+namespace {
+/**
+ * Reads the blocks, which the index sync is going to write next, ahead of
+ * time on a pool of threads. Reading a block includes deserializing it and
+ * checking its proof of work, which is expensive with NeoScrypt, so the
+ * writes to the index no longer wait for it.
+ *
+ * The blocks are scheduled and handed out in chain order. When a scheduled
+ * block is not the next block of the sync anymore, e.g. after a reorg, the
+ * schedule is dropped and started again.
+ */
+class BlockPrefetcher
+{
+    struct Job
+    {
+        const CBlockIndex* const pindex;
+        std::shared_ptr<const CBlock> block;
+        bool done = false;
+
+        explicit Job(const CBlockIndex* pindex_in) : pindex(pindex_in) {}
+    };
+
+    const Consensus::Params& m_consensus_params;
+
+    Mutex m_mutex;
+    //! Notified when a job is scheduled, when a job is done and on stop
+    std::condition_variable m_cv;
+    //! All scheduled jobs, in chain order
+    std::deque<std::shared_ptr<Job>> m_jobs GUARDED_BY(m_mutex);
+    //! Jobs not yet taken by a reader thread
+    std::deque<std::shared_ptr<Job>> m_unclaimed GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex) = false;
+
+    std::vector<std::thread> m_threads;
+
+    void ThreadRead()
+    {
+        while (true) {
+            std::shared_ptr<Job> job;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [this]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_unclaimed.empty(); });
+                if (m_stop) return;
+                job = std::move(m_unclaimed.front());
+                m_unclaimed.pop_front();
+            }
+
+            std::shared_ptr<CBlock> block = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*block, job->pindex, m_consensus_params)) {
+                block.reset();
+            }
+            {
+                LOCK(m_mutex);
+                job->block = std::move(block);
+                job->done = true;
+            }
+            m_cv.notify_all();
+        }
+    }
+
+public:
+    BlockPrefetcher(const Consensus::Params& consensus_params, int num_threads) : m_consensus_params(consensus_params)
+    {
+        for (int i = 0; i < num_threads; ++i) {
+            m_threads.emplace_back(&BlockPrefetcher::ThreadRead, this);
+        }
+    }
+
+    ~BlockPrefetcher()
+    {
+        {
+            LOCK(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    /** Schedule pindex and the blocks following it in the active chain, if not done yet. */
+    void Schedule(const CBlockIndex* pindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+    {
+        AssertLockHeld(cs_main);
+        {
+            LOCK(m_mutex);
+            if (!m_jobs.empty() && m_jobs.front()->pindex != pindex) {
+                m_jobs.clear();
+                m_unclaimed.clear();
+            }
+            const CBlockIndex* pindex_last = m_jobs.empty() ? nullptr : m_jobs.back()->pindex;
+            while (m_jobs.size() < SYNC_PREFETCH_BLOCKS) {
+                pindex_last = pindex_last ? chainActive.Next(pindex_last) : pindex;
+                if (!pindex_last) break;
+                m_jobs.push_back(std::make_shared<Job>(pindex_last));
+                m_unclaimed.push_back(m_jobs.back());
+            }
+        }
+        m_cv.notify_all();
+    }
+
+    /** Wait for pindex, which must be the first scheduled block, to be read. Returns null if reading failed. */
+    std::shared_ptr<const CBlock> Get(const CBlockIndex* pindex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        assert(!m_jobs.empty() && m_jobs.front()->pindex == pindex);
+        std::shared_ptr<Job> job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_cv.wait(lock, [&job]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return job->done; });
+        return std::move(job->block);
+    }
+};
+} // namespace
+
 void BaseIndex::ThreadSync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
-        auto& consensus_params = Params().GetConsensus();
+        BlockPrefetcher prefetcher(Params().GetConsensus(), std::max(1, std::min(GetNumCores(), MAX_SYNC_READ_THREADS)));
+
+        // Write the entries of many blocks at once, which is much cheaper for LevelDB
+        CDBBatch batch(GetDB());
+        const size_t batch_size = (size_t)gArgs.GetArg("-dbbatchsize", nDefaultDbBatchSize);
 
         int64_t last_log_time = 0;
         int64_t last_locator_write_time = 0;
         while (true) {
             if (m_interrupt) {
-                WriteBestBlock(pindex);
+                Commit(batch, pindex);
                 return;
             }
 
+            const CBlockIndex* pindex_next;
             {
                 LOCK(cs_main);
-                const CBlockIndex* pindex_next = NextSyncBlock(pindex);
+                pindex_next = NextSyncBlock(pindex);
                 if (!pindex_next) {
-                    WriteBestBlock(pindex);
+                    if (!Commit(batch, pindex)) {
+                        FatalError("%s: Failed to commit latest %s state", __func__, GetName());
+                        return;
+                    }
                     m_best_block_index = pindex;
                     m_synced = true;
                     break;
                 }
-                pindex = pindex_next;
+                prefetcher.Schedule(pindex_next);
             }
 
             int64_t current_time = GetTime();
             if (last_log_time + SYNC_LOG_INTERVAL < current_time) {
                 LogPrintf("Syncing %s with block chain from height %d\n",
-                          GetName(), pindex->nHeight);
+                          GetName(), pindex_next->nHeight);
                 last_log_time = current_time;
             }
 
-            if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL < current_time) {
-                WriteBestBlock(pindex);
-                last_locator_write_time = current_time;
-            }
-
-            CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            std::shared_ptr<const CBlock> block = prefetcher.Get(pindex_next);
+            if (!block) {
                 FatalError("%s: Failed to read block %s from disk",
-                           __func__, pindex->GetBlockHash().ToString());
+                           __func__, pindex_next->GetBlockHash().ToString());
                 return;
             }
-            if (!WriteBlock(block, pindex)) {
+            if (!WriteBlock(*block, pindex_next, batch)) {
                 FatalError("%s: Failed to write block %s to index database",
-                           __func__, pindex->GetBlockHash().ToString());
+                           __func__, pindex_next->GetBlockHash().ToString());
                 return;
             }
+            pindex = pindex_next;
+
+            if (batch.SizeEstimate() > batch_size || last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL < current_time) {
+                if (!Commit(batch, pindex)) {
+                    FatalError("%s: Failed to write block %s to index database",
+                               __func__, pindex->GetBlockHash().ToString());
+                    return;
+                }
+                last_locator_write_time = current_time;
+            }
         }
     }
 
@@ -144,12 +284,16 @@ void BaseIndex::ThreadSync()
     }
 }
 
-bool BaseIndex::WriteBestBlock(const CBlockIndex* block_index)
+bool BaseIndex::Commit(CDBBatch& batch, const CBlockIndex* block_index)
 {
-    LOCK(cs_main);
-    if (!GetDB().WriteBestBlock(chainActive.GetLocator(block_index))) {
-        return error("%s: Failed to write locator to disk", __func__);
+    {
+        LOCK(cs_main);
+        GetDB().WriteBestBlock(batch, chainActive.GetLocator(block_index));
+    }
+    if (!GetDB().WriteBatch(batch)) {
+        return error("%s: Failed to write batch to disk", __func__);
     }
+    batch.Clear();
     return true;
 }
 
@@ -182,7 +326,8 @@ void BaseIndex::BlockConnected(const std::shared_ptr<const CBlock>& block, const
         }
     }
 
-    if (WriteBlock(*block, pindex)) {
+    CDBBatch batch(GetDB());
+    if (WriteBlock(*block, pindex, batch) && GetDB().WriteBatch(batch)) {
         m_best_block_index = pindex;
     } else {
         FatalError("%s: Failed to write block %s to index",
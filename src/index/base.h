@@ -33,6 +33,9 @@ protected:
 
         /// Write block locator of the chain that the txindex is in sync with.
         bool WriteBestBlock(const CBlockLocator& locator);
+
+        /// Add the block locator of the chain that the txindex is in sync with to a batch.
+        void WriteBestBlock(CDBBatch& batch, const CBlockLocator& locator);
     };
 
 private:
@@ -54,8 +57,9 @@ private:
     /// over and the sync thread exits.
     void ThreadSync();
 
-    /// Write the current chain block locator to the DB.
-    bool WriteBestBlock(const CBlockIndex* block_index);
+    /// Write the batch of index entries to the DB, together with the current
+    /// chain block locator, and clear it.
+    bool Commit(CDBBatch& batch, const CBlockIndex* block_index);
 
 protected:
     void BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex,
@@ -66,8 +70,10 @@ protected:
     /// Initialize internal state from the database and block index.
     virtual bool Init();
 
-    /// Write update index entries for a newly connected block.
-    virtual bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) { return true; }
+    /// Write update index entries for a newly connected block to the batch.
+    /// During the initial sync, the batch holds the entries of several blocks
+    /// and is written to the DB by the caller.
+    virtual bool WriteBlock(const CBlock& block, const CBlockIndex* pindex, CDBBatch& batch) { return true; }
 
     virtual DB& GetDB() const = 0;
 
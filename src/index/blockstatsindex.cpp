@@ -0,0 +1,74 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/blockstatsindex.h>
+#include <undo.h>
+#include <util/system.h>
+#include <validation.h>
+
+constexpr char DB_BLOCK_STATS = 's';
+
+std::unique_ptr<BlockStatsIndex> g_blockstatsindex;
+
+/**
+ * Access to the block statistics database (indexes/blockstats/)
+ *
+ * Besides the statistics, the database stores a block locator of the chain
+ * the database is synced to, see BaseIndex.
+ */
+class BlockStatsIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Read the statistics of the block with the given hash. Returns false if the
+    /// block is not indexed.
+    bool ReadStats(const uint256& block_hash, CBlockStats& stats) const;
+
+    /// Add the statistics of the block with the given hash to a batch.
+    void WriteStats(CDBBatch& batch, const uint256& block_hash, const CBlockStats& stats);
+};
+
+BlockStatsIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "blockstats", n_cache_size, f_memory, f_wipe)
+{}
+
+bool BlockStatsIndex::DB::ReadStats(const uint256& block_hash, CBlockStats& stats) const
+{
+    return Read(std::make_pair(DB_BLOCK_STATS, block_hash), stats);
+}
+
+void BlockStatsIndex::DB::WriteStats(CDBBatch& batch, const uint256& block_hash, const CBlockStats& stats)
+{
+    batch.Write(std::make_pair(DB_BLOCK_STATS, block_hash), stats);
+}
+
+BlockStatsIndex::BlockStatsIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<BlockStatsIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+BlockStatsIndex::~BlockStatsIndex() {}
+
+bool BlockStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex, CDBBatch& batch)
+{
+    CBlockUndo blockundo;
+    // The genesis block has no undo data
+    if (pindex->pprev && !UndoReadFromDisk(blockundo, pindex)) {
+        return error("%s: Failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    CBlockStats stats;
+    if (!ComputeBlockStats(block, blockundo, stats)) {
+        return error("%s: Undo data does not match block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    m_db->WriteStats(batch, pindex->GetBlockHash(), stats);
+    return true;
+}
+
+BaseIndex::DB& BlockStatsIndex::GetDB() const { return *m_db; }
+
+bool BlockStatsIndex::LookupStats(const CBlockIndex* pindex, CBlockStats& stats) const
+{
+    return m_db->ReadStats(pindex->GetBlockHash(), stats);
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_BLOCKSTATSINDEX_H
+#define BITCOIN_INDEX_BLOCKSTATSINDEX_H
+
+#include <chain.h>
+#include <index/base.h>
+#include <rpc/blockchain.h>
+
+static const bool DEFAULT_BLOCKSTATSINDEX = false;
+
+/**
+ * BlockStatsIndex is used to serve getblockstats without reading blocks and
+ * undo data from disk. The statistics of each connected block are calculated
+ * once and written to a LevelDB database, keyed by block hash. As the
+ * statistics only depend on the block itself, entries of blocks that were
+ * disconnected in a reorg stay valid and no rollback is required.
+ */
+class BlockStatsIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex, CDBBatch& batch) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "blockstatsindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit BlockStatsIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~BlockStatsIndex() override;
+
+    /// Look up the statistics of a block. Returns false if the block is not indexed.
+    bool LookupStats(const CBlockIndex* pindex, CBlockStats& stats) const;
+};
+
+/// The global block statistics index, used in getblockstats. May be null.
+extern std::unique_ptr<BlockStatsIndex> g_blockstatsindex;
+
+#endif // BITCOIN_INDEX_BLOCKSTATSINDEX_H
@@ -8,6 +8,9 @@
 #include <util/system.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <tuple>
+
 #include <boost/thread.hpp>
 
 constexpr char DB_BEST_BLOCK = 'B';
@@ -59,8 +62,8 @@ public:
     /// transaction hash is not indexed.
     bool ReadTxPos(const uint256& txid, CDiskTxPos& pos) const;
 
-    /// Write a batch of transaction positions to the DB.
-    bool WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos);
+    /// Add transaction positions to a batch.
+    void WriteTxs(CDBBatch& batch, const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos);
 
     /// Migrate txindex data from the block tree DB, where it may be for older nodes that have not
     /// been upgraded yet to the new database.
@@ -76,13 +79,11 @@ bool TxIndex::DB::ReadTxPos(const uint256 &txid, CDiskTxPos& pos) const
     return Read(std::make_pair(DB_TXINDEX, txid), pos);
 }
 
-bool TxIndex::DB::WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos)
+void TxIndex::DB::WriteTxs(CDBBatch& batch, const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos)
 {
-    CDBBatch batch(*this);
     for (const auto& tuple : v_pos) {
         batch.Write(std::make_pair(DB_TXINDEX, tuple.first), tuple.second);
     }
-    return WriteBatch(batch);
 }
 
 /*
@@ -243,7 +244,7 @@ bool TxIndex::Init()
     return BaseIndex::Init();
 }
 
-bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex, CDBBatch& batch)
 {
     // Exclude genesis block transaction because outputs are not spendable.
     if (pindex->nHeight == 0) return true;
@@ -255,7 +256,8 @@ bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
         vPos.emplace_back(tx->GetHash(), pos);
         pos.nTxOffset += ::GetSerializeSize(*tx, CLIENT_VERSION);
     }
-    return m_db->WriteTxs(vPos);
+    m_db->WriteTxs(batch, vPos);
+    return true;
 }
 
 BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
@@ -297,3 +299,71 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
     block_hash = header.GetHash();
     return true;
 }
+
+void TxIndex::FindTxs(const std::vector<uint256>& tx_hashes, std::vector<uint256>& block_hashes, std::vector<CTransactionRef>& txs) const
+{
+    block_hashes.assign(tx_hashes.size(), uint256());
+    txs.assign(tx_hashes.size(), nullptr);
+
+    std::vector<std::pair<CDiskTxPos, size_t>> positions;
+    positions.reserve(tx_hashes.size());
+    for (size_t i = 0; i < tx_hashes.size(); ++i) {
+        CDiskTxPos postx;
+        if (m_db->ReadTxPos(tx_hashes[i], postx)) {
+            positions.emplace_back(postx, i);
+        }
+    }
+    std::sort(positions.begin(), positions.end(), [](const std::pair<CDiskTxPos, size_t>& a, const std::pair<CDiskTxPos, size_t>& b) {
+        return std::tie(a.first.nFile, a.first.nPos, a.first.nTxOffset) < std::tie(b.first.nFile, b.first.nPos, b.first.nTxOffset);
+    });
+
+    std::unique_ptr<CAutoFile> file;
+    int file_num = -1;
+    CDiskBlockPos block_pos;
+    uint256 block_hash;
+    long tx_start = 0;
+    for (const auto& entry : positions) {
+        const CDiskTxPos& postx = entry.first;
+        const uint256& tx_hash = tx_hashes[entry.second];
+        if (postx.nFile != file_num) {
+            file_num = postx.nFile;
+            block_pos.SetNull();
+            file.reset(new CAutoFile(OpenBlockFile(CDiskBlockPos(postx.nFile, 0), true), SER_DISK, CLIENT_VERSION));
+            if (file->IsNull()) {
+                error("%s: OpenBlockFile failed", __func__);
+            }
+        }
+        if (file->IsNull()) {
+            continue;
+        }
+        try {
+            if (postx.nPos != block_pos.nPos || block_pos.IsNull()) {
+                block_pos.SetNull();
+                if (fseek(file->Get(), postx.nPos, SEEK_SET)) {
+                    error("%s: fseek(...) failed", __func__);
+                    continue;
+                }
+                CBlockHeader header;
+                *file >> header;
+                tx_start = ftell(file->Get());
+                block_hash = header.GetHash();
+                block_pos = postx;
+            }
+            if (fseek(file->Get(), tx_start + postx.nTxOffset, SEEK_SET)) {
+                error("%s: fseek(...) failed", __func__);
+                continue;
+            }
+            CTransactionRef tx;
+            *file >> tx;
+            if (tx->GetHash() != tx_hash) {
+                error("%s: txid mismatch", __func__);
+                continue;
+            }
+            txs[entry.second] = std::move(tx);
+            block_hashes[entry.second] = block_hash;
+        } catch (const std::exception& e) {
+            error("%s: Deserialize or I/O error - %s", __func__, e.what());
+            block_pos.SetNull();
+        }
+    }
+}
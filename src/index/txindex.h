@@ -26,7 +26,7 @@ protected:
     /// Override base class init to migrate from old database.
     bool Init() override;
 
-    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex, CDBBatch& batch) override;
 
     BaseIndex::DB& GetDB() const override;
 
@@ -48,6 +48,14 @@ public:
     /// @param[out]  tx  The transaction itself.
     /// @return  true if transaction is found, false otherwise
     bool FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const;
+
+    /// Look up several transactions by hash. The transactions are read in the order they are
+    /// stored on disk, so that each block file is opened once and each block header is read once.
+    ///
+    /// @param[in]   tx_hashes  The hashes of the transactions to be returned.
+    /// @param[out]  block_hashes  The hashes of the blocks the transactions are found in.
+    /// @param[out]  txs  The transactions, in the order of tx_hashes. Null if not found.
+    void FindTxs(const std::vector<uint256>& tx_hashes, std::vector<uint256>& block_hashes, std::vector<CTransactionRef>& txs) const;
 };
 
 /// The global transaction index, used in GetTransaction. May be null.
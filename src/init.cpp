@@ -12,6 +12,7 @@
 #include <addrman.h>
 #include <amount.h>
 #include <banman.h>
+#include <blockcache.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -22,6 +23,7 @@
 #include <httpserver.h>
 #include <httprpc.h>
 #include <interfaces/chain.h>
+#include <index/blockstatsindex.h>
 #include <index/txindex.h>
 #include <key.h>
 #include <validation.h>
@@ -196,6 +198,9 @@ void Interrupt()
     if (g_txindex) {
         g_txindex->Interrupt();
     }
+    if (g_blockstatsindex) {
+        g_blockstatsindex->Interrupt();
+    }
 }
 
 void Shutdown(InitInterfaces& interfaces)
@@ -227,6 +232,7 @@ void Shutdown(InitInterfaces& interfaces)
     if (peerLogic) UnregisterValidationInterface(peerLogic.get());
     if (g_connman) g_connman->Stop();
     if (g_txindex) g_txindex->Stop();
+    if (g_blockstatsindex) g_blockstatsindex->Stop();
 
     StopTorControl();
 
@@ -241,6 +247,7 @@ void Shutdown(InitInterfaces& interfaces)
     g_connman.reset();
     g_banman.reset();
     g_txindex.reset();
+    g_blockstatsindex.reset();
 
     if (g_is_mempool_loaded && gArgs.GetArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
         DumpMempool();
@@ -312,6 +319,7 @@ void Shutdown(InitInterfaces& interfaces)
     globalVerifyHandle.reset();
     ECC_Stop();
     LogPrintf("%s: done\n", __func__);
+    LogInstance().StopAsyncWriter();
 }
 
 /**
@@ -385,9 +393,11 @@ void SetupServerArgs()
     gArgs.AddArg("-alertnotify=<cmd>", "Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)", false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-assumevalid=<hex>", strprintf("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s)", defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex()), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocksdir=<dir>", "Specify blocks directory (default: <datadir>/blocks)", false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockcachesize=<n>", strprintf("Keep up to <n> recently connected blocks in memory, 0 to disable (default: %u)", DEFAULT_BLOCK_CACHE_SIZE), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocknotify=<cmd>", "Execute command when the best block changes (%s in cmd is replaced by block hash)", false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blockreconstructionextratxn=<n>", strprintf("Extra transactions to keep in memory for compact block reconstructions (default: %u)", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocksonly", strprintf("Whether to reject transactions from network peers. Transactions from the wallet or RPC are not affected. (default: %u)", DEFAULT_BLOCKSONLY), false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockstatsindex", strprintf("Maintain an index of per block statistics, used by the getblockstats rpc call (default: %u)", DEFAULT_BLOCKSTATSINDEX), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-conf=<file>", strprintf("Specify configuration file. Relative paths will be prefixed by datadir location. (default: %s)", BITCOIN_CONF_FILENAME), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-datadir=<dir>", "Specify data directory", false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-dbbatchsize", strprintf("Maximum database write batch size in bytes (default: %u)", nDefaultDbBatchSize), true, OptionsCategory::OPTIONS);
@@ -508,6 +518,7 @@ void SetupServerArgs()
     gArgs.AddArg("-debugexclude=<category>", strprintf("Exclude debugging information for a category. Can be used in conjunction with -debug=1 to output debug logs for all categories except one or more specified categories."), false, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logips", strprintf("Include IP addresses in debug output (default: %u)", DEFAULT_LOGIPS), false, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logtimestamps", strprintf("Prepend debug output with timestamp (default: %u)", DEFAULT_LOGTIMESTAMPS), false, OptionsCategory::DEBUG_TEST);
+    gArgs.AddArg("-logqueuesize=<n>", strprintf("Write the debug log file from a background thread, queueing up to <n> messages, further ones are dropped (0 to write synchronously, default: %u)", DEFAULT_LOGQUEUESIZE), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-mocktime=<n>", "Replace actual time with <n> seconds since epoch (default: 0)", true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxsigcachesize=<n>", strprintf("Limit sum of signature cache and script execution cache sizes to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE), true, OptionsCategory::DEBUG_TEST);
@@ -990,6 +1001,8 @@ bool AppInitParameterInteraction()
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        if (gArgs.GetBoolArg("-blockstatsindex", DEFAULT_BLOCKSTATSINDEX))
+            return InitError(_("Prune mode is incompatible with -blockstatsindex."));
     }
 
     // -bind and -whitebind can't be set when not listening
@@ -1280,6 +1293,10 @@ bool AppInitMain(InitInterfaces& interfaces)
             return InitError(strprintf("Could not open debug log file %s",
                 LogInstance().m_file_path.string()));
         }
+        const int64_t log_queue_size = gArgs.GetArg("-logqueuesize", DEFAULT_LOGQUEUESIZE);
+        if (log_queue_size > 0) {
+            LogInstance().StartAsyncWriter(log_queue_size);
+        }
     }
 
     if (!LogInstance().m_log_timestamps)
@@ -1508,6 +1525,8 @@ bool AppInitMain(InitInterfaces& interfaces)
     nTotalCache -= nBlockTreeDBCache;
     int64_t nTxIndexCache = std::min(nTotalCache / 8, gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache << 20 : 0);
     nTotalCache -= nTxIndexCache;
+    int64_t nBlockStatsIndexCache = std::min(nTotalCache / 8, gArgs.GetBoolArg("-blockstatsindex", DEFAULT_BLOCKSTATSINDEX) ? nMaxBlockStatsIndexCache << 20 : 0);
+    nTotalCache -= nBlockStatsIndexCache;
     int64_t nCoinDBCache = std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     nCoinDBCache = std::min(nCoinDBCache, nMaxCoinsDBCache << 20); // cap total coins db cache
     nTotalCache -= nCoinDBCache;
@@ -1518,8 +1537,14 @@ bool AppInitMain(InitInterfaces& interfaces)
     if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         LogPrintf("* Using %.1f MiB for transaction index database\n", nTxIndexCache * (1.0 / 1024 / 1024));
     }
+    if (gArgs.GetBoolArg("-blockstatsindex", DEFAULT_BLOCKSTATSINDEX)) {
+        LogPrintf("* Using %.1f MiB for block statistics index database\n", nBlockStatsIndexCache * (1.0 / 1024 / 1024));
+    }
     LogPrintf("* Using %.1f MiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1f MiB for in-memory UTXO set (plus up to %.1f MiB of unused mempool space)\n", nCoinCacheUsage * (1.0 / 1024 / 1024), nMempoolSizeMax * (1.0 / 1024 / 1024));
+    const int64_t nBlockCacheSize = std::max<int64_t>(0, gArgs.GetArg("-blockcachesize", DEFAULT_BLOCK_CACHE_SIZE));
+    g_block_cache.SetMaxSize(nBlockCacheSize);
+    LogPrintf("* Using %d blocks for recently connected block cache\n", nBlockCacheSize);
 
     bool fLoaded = false;
     while (!fLoaded && !ShutdownRequested()) {
@@ -1719,6 +1744,11 @@ bool AppInitMain(InitInterfaces& interfaces)
         g_txindex->Start();
     }
 
+    if (gArgs.GetBoolArg("-blockstatsindex", DEFAULT_BLOCKSTATSINDEX)) {
+        g_blockstatsindex = MakeUnique<BlockStatsIndex>(nBlockStatsIndexCache, false, fReindex);
+        g_blockstatsindex->Start();
+    }
+
     // ********************************************************* Step 8.5: load omni core
 
     uiInterface.InitMessage(_("Parsing Omni Layer transactions..."));
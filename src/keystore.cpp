@@ -13,6 +13,8 @@ void CBasicKeyStore::ImplicitlyLearnRelatedKeyScripts(const CPubKey& pubkey)
     CKeyID key_id = pubkey.GetID();
     // We must actually know about this key already.
     assert(HaveKey(key_id) || mapWatchKeys.count(key_id));
+    setCandidateScriptPubKeys.insert(GetScriptForRawPubKey(pubkey));
+    setCandidateScriptPubKeys.insert(GetScriptForDestination(key_id));
     // This adds the redeemscripts necessary to detect P2WPKH and P2SH-P2WPKH
     // outputs. Technically P2WPKH outputs don't have a redeemscript to be
     // spent. However, our current IsMine logic requires the corresponding
@@ -28,10 +30,19 @@ void CBasicKeyStore::ImplicitlyLearnRelatedKeyScripts(const CPubKey& pubkey)
         CScript script = GetScriptForDestination(WitnessV0KeyHash(key_id));
         // This does not use AddCScript, as it may be overridden.
         CScriptID id(script);
+        setCandidateScriptPubKeys.insert(script);
+        AddCandidateScriptPubKeys(script);
         mapScripts[id] = std::move(script);
     }
 }
 
+void CBasicKeyStore::AddCandidateScriptPubKeys(const CScript& redeemScript)
+{
+    AssertLockHeld(cs_KeyStore);
+    setCandidateScriptPubKeys.insert(GetScriptForDestination(CScriptID(redeemScript)));
+    setCandidateScriptPubKeys.insert(GetScriptForDestination(WitnessV0ScriptHash(redeemScript)));
+}
+
 bool CBasicKeyStore::GetPubKey(const CKeyID &address, CPubKey &vchPubKeyOut) const
 {
     CKey key;
@@ -90,6 +101,7 @@ bool CBasicKeyStore::AddCScript(const CScript& redeemScript)
 
     LOCK(cs_KeyStore);
     mapScripts[CScriptID(redeemScript)] = redeemScript;
+    AddCandidateScriptPubKeys(redeemScript);
     return true;
 }
 
@@ -141,6 +153,7 @@ bool CBasicKeyStore::AddWatchOnly(const CScript &dest)
 {
     LOCK(cs_KeyStore);
     setWatchOnly.insert(dest);
+    setCandidateScriptPubKeys.insert(dest);
     CPubKey pubKey;
     if (ExtractPubKey(dest, pubKey)) {
         mapWatchKeys[pubKey.GetID()] = pubKey;
@@ -174,6 +187,12 @@ bool CBasicKeyStore::HaveWatchOnly() const
     return (!setWatchOnly.empty());
 }
 
+bool CBasicKeyStore::IsMineCandidate(const CScript& scriptPubKey) const
+{
+    LOCK(cs_KeyStore);
+    return setCandidateScriptPubKeys.count(scriptPubKey) > 0;
+}
+
 CKeyID GetKeyForDestination(const CKeyStore& store, const CTxDestination& dest)
 {
     // Only supports destinations which map to single public keys, i.e. P2PKH,
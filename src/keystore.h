@@ -6,6 +6,7 @@
 #ifndef BITCOIN_KEYSTORE_H
 #define BITCOIN_KEYSTORE_H
 
+#include <coins.h>
 #include <key.h>
 #include <pubkey.h>
 #include <script/script.h>
@@ -13,6 +14,8 @@
 #include <script/standard.h>
 #include <sync.h>
 
+#include <unordered_set>
+
 #include <boost/signals2/signal.hpp>
 
 /** A virtual base class for key stores */
@@ -36,6 +39,12 @@ public:
     virtual bool RemoveWatchOnly(const CScript &dest) =0;
     virtual bool HaveWatchOnly(const CScript &dest) const =0;
     virtual bool HaveWatchOnly() const =0;
+
+    /**
+     * Cheap first pass of IsMine: returns false only if the scriptPubKey can
+     * not be ours. False positives are allowed.
+     */
+    virtual bool IsMineCandidate(const CScript& scriptPubKey) const { return true; }
 };
 
 /** Basic key store, that keeps keys in an address->secret map */
@@ -48,13 +57,23 @@ protected:
     using WatchKeyMap = std::map<CKeyID, CPubKey>;
     using ScriptMap = std::map<CScriptID, CScript>;
     using WatchOnlySet = std::set<CScript>;
+    using ScriptPubKeySet = std::unordered_set<CScript, SaltedScriptHasher>;
 
     KeyMap mapKeys GUARDED_BY(cs_KeyStore);
     WatchKeyMap mapWatchKeys GUARDED_BY(cs_KeyStore);
     ScriptMap mapScripts GUARDED_BY(cs_KeyStore);
     WatchOnlySet setWatchOnly GUARDED_BY(cs_KeyStore);
 
+    /**
+     * All scriptPubKeys, for which IsMine may return anything but ISMINE_NO:
+     * the P2PK, P2PKH and P2WPKH scripts of the keys, the P2SH and P2WSH
+     * scripts of the redeem scripts, and the watch-only scripts. Entries are
+     * never removed, as a superset is harmless.
+     */
+    ScriptPubKeySet setCandidateScriptPubKeys GUARDED_BY(cs_KeyStore);
+
     void ImplicitlyLearnRelatedKeyScripts(const CPubKey& pubkey) EXCLUSIVE_LOCKS_REQUIRED(cs_KeyStore);
+    void AddCandidateScriptPubKeys(const CScript& redeemScript) EXCLUSIVE_LOCKS_REQUIRED(cs_KeyStore);
 
 public:
     bool AddKeyPubKey(const CKey& key, const CPubKey &pubkey) override;
@@ -72,6 +91,8 @@ public:
     bool RemoveWatchOnly(const CScript &dest) override;
     bool HaveWatchOnly(const CScript &dest) const override;
     bool HaveWatchOnly() const override;
+
+    bool IsMineCandidate(const CScript& scriptPubKey) const override;
 };
 
 /** Return the CKeyID of the key involved in a script (if there is a unique one). */
@@ -6,6 +6,10 @@
 #include <logging.h>
 #include <util/time.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
 const char * const DEFAULT_DEBUGLOGFILE = "debug.log";
 
 BCLog::Logger& LogInstance()
@@ -39,6 +43,115 @@ static int FileWriteStr(const std::string &str, FILE *fp)
     return fwrite(str.data(), 1, str.size(), fp);
 }
 
+/**
+ * Bounded lock-free queue of log messages, which may be pushed from any
+ * thread, and is drained by the writer thread (or a flush).
+ *
+ * Each slot carries a sequence number, which tells whether it is free for
+ * the producer at a given position, or filled for the consumer at that
+ * position, so that neither side ever waits for the other.
+ */
+class BCLog::AsyncLogWriter
+{
+private:
+    struct Slot
+    {
+        std::atomic<size_t> seq;
+        std::string msg;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    const size_t m_mask;
+    std::atomic<size_t> m_enqueue_pos{0};
+    std::atomic<size_t> m_dequeue_pos{0};
+
+    static size_t RoundUpPowerOfTwo(size_t n)
+    {
+        size_t capacity = 2;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+public:
+    std::thread m_thread;
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake_cv;
+    std::atomic<bool> m_sleeping{false};
+    std::atomic<bool> m_stop{false};
+
+    explicit AsyncLogWriter(size_t queue_size) : m_mask(RoundUpPowerOfTwo(queue_size) - 1)
+    {
+        m_slots.reset(new Slot[m_mask + 1]);
+        for (size_t i = 0; i <= m_mask; ++i) {
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /** Queue a message, returns false, if the queue is full. */
+    bool Push(std::string&& msg)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &m_slots[pos & m_mask];
+            const size_t seq = slot->seq.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->msg = std::move(msg);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Take the oldest message, returns false, if the queue is empty. */
+    bool Pop(std::string& msg)
+    {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &m_slots[pos & m_mask];
+            const size_t seq = slot->seq.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        msg = std::move(slot->msg);
+        slot->msg.clear();
+        slot->seq.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const
+    {
+        const size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        return m_slots[pos & m_mask].seq.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    /** Wake up the writer thread, if it waits for messages. */
+    void Wake()
+    {
+        if (m_sleeping.load()) {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            m_wake_cv.notify_one();
+        }
+    }
+};
+
+BCLog::Logger::Logger() {}
+
+BCLog::Logger::~Logger() {}
+
 bool BCLog::Logger::OpenDebugLog()
 {
     std::lock_guard<std::mutex> scoped_lock(m_file_mutex);
@@ -61,6 +174,98 @@ bool BCLog::Logger::OpenDebugLog()
     return true;
 }
 
+void BCLog::Logger::WriteToFile(const std::string& str)
+{
+    // reopen the log file, if requested
+    if (m_reopen_file) {
+        m_reopen_file = false;
+        FILE* new_fileout = fsbridge::fopen(m_file_path, "a");
+        if (new_fileout) {
+            setbuf(new_fileout, nullptr); // unbuffered
+            fclose(m_fileout);
+            m_fileout = new_fileout;
+        }
+    }
+    FileWriteStr(str, m_fileout);
+}
+
+void BCLog::Logger::StartAsyncWriter(size_t queue_size)
+{
+    assert(m_fileout != nullptr);
+    assert(!m_async_writer);
+
+    m_async_writer.reset(new AsyncLogWriter(queue_size));
+    m_async_writer->m_thread = std::thread(&BCLog::Logger::AsyncWriterThread, this);
+    m_async = true;
+}
+
+void BCLog::Logger::StopAsyncWriter()
+{
+    if (!m_async) return;
+    m_async = false;
+
+    // Wait for threads, which saw the writer still running, to queue their
+    // messages. Any later thread sees m_async cleared and writes on its own.
+    while (m_async_pushers.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_async_writer->m_wake_mutex);
+        m_async_writer->m_stop = true;
+        m_async_writer->m_wake_cv.notify_one();
+    }
+    // The writer thread drains the queue once more, before it exits
+    m_async_writer->m_thread.join();
+}
+
+void BCLog::Logger::Flush()
+{
+    if (!m_async_writer) return;
+
+    std::lock_guard<std::mutex> scoped_lock(m_file_mutex);
+
+    // Write the messages in batches, to save system calls on the unbuffered file
+    static const size_t MAX_BATCH_SIZE = 1 << 16;
+    std::string batch;
+    std::string msg;
+    while (m_async_writer->Pop(msg)) {
+        batch += msg;
+        if (batch.size() >= MAX_BATCH_SIZE) {
+            WriteToFile(batch);
+            batch.clear();
+        }
+    }
+
+    const uint64_t dropped = m_dropped.load();
+    if (dropped != m_dropped_reported) {
+        batch += strprintf("%s Dropped %u log messages, as the log queue was full\n", FormatISO8601DateTime(GetTime()), dropped - m_dropped_reported);
+        m_dropped_reported = dropped;
+    }
+
+    if (!batch.empty()) {
+        WriteToFile(batch);
+    }
+}
+
+void BCLog::Logger::AsyncWriterThread()
+{
+    AsyncLogWriter& writer = *m_async_writer;
+    while (!writer.m_stop) {
+        Flush();
+
+        // Announce the wait before checking for messages, so that a message
+        // pushed in between either is seen, or wakes us up
+        std::unique_lock<std::mutex> lock(writer.m_wake_mutex);
+        writer.m_sleeping = true;
+        if (writer.Empty() && !writer.m_stop) {
+            writer.m_wake_cv.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        writer.m_sleeping = false;
+    }
+    Flush();
+}
+
 void BCLog::Logger::EnableCategory(BCLog::LogFlags flag)
 {
     m_categories |= flag;
@@ -218,6 +423,20 @@ void BCLog::Logger::LogPrintStr(const std::string &str)
         fflush(stdout);
     }
     if (m_print_to_file) {
+        // hand over to the writer thread, if running. Announcing the push
+        // before checking m_async lets StopAsyncWriter() wait for it.
+        ++m_async_pushers;
+        if (m_async) {
+            if (m_async_writer->Push(std::move(strTimestamped))) {
+                m_async_writer->Wake();
+            } else {
+                ++m_dropped;
+            }
+            --m_async_pushers;
+            return;
+        }
+        --m_async_pushers;
+
         std::lock_guard<std::mutex> scoped_lock(m_file_mutex);
 
         // buffer if we haven't opened the log yet
@@ -226,17 +445,7 @@ void BCLog::Logger::LogPrintStr(const std::string &str)
         }
         else
         {
-            // reopen the log file, if requested
-            if (m_reopen_file) {
-                m_reopen_file = false;
-                FILE* new_fileout = fsbridge::fopen(m_file_path, "a");
-                if (new_fileout) {
-                    setbuf(new_fileout, nullptr); // unbuffered
-                    fclose(m_fileout);
-                    m_fileout = new_fileout;
-                }
-            }
-            FileWriteStr(strTimestamped, m_fileout);
+            WriteToFile(strTimestamped);
         }
     }
 }
@@ -12,6 +12,7 @@
 #include <atomic>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -19,6 +20,7 @@
 static const bool DEFAULT_LOGTIMEMICROS = false;
 static const bool DEFAULT_LOGIPS        = false;
 static const bool DEFAULT_LOGTIMESTAMPS = true;
+static const unsigned int DEFAULT_LOGQUEUESIZE = 0;
 extern const char * const DEFAULT_DEBUGLOGFILE;
 
 extern bool fLogIPs;
@@ -60,6 +62,8 @@ namespace BCLog {
         ALL         = ~(uint32_t)0,
     };
 
+    class AsyncLogWriter;
+
     class Logger
     {
     private:
@@ -67,6 +71,15 @@ namespace BCLog {
         std::mutex m_file_mutex;
         std::list<std::string> m_msgs_before_open;
 
+        /** Queue and thread writing the log file in the background, if started. */
+        std::unique_ptr<AsyncLogWriter> m_async_writer;
+        std::atomic<bool> m_async{false};
+        /** Threads, which may be about to queue a message, as they saw m_async set. */
+        std::atomic<int> m_async_pushers{0};
+        /** Messages dropped, because the queue was full, and the number already reported in the log. */
+        std::atomic<uint64_t> m_dropped{0};
+        uint64_t m_dropped_reported = 0;
+
         /**
          * m_started_new_line is a state variable that will suppress printing of
          * the timestamp when multiple calls are made that don't end in a
@@ -79,7 +92,15 @@ namespace BCLog {
 
         std::string LogTimestampStr(const std::string& str);
 
+        /** Write to the log file, reopening it first, if requested. Requires m_file_mutex. */
+        void WriteToFile(const std::string& str);
+
+        void AsyncWriterThread();
+
     public:
+        Logger();
+        ~Logger();
+
         bool m_print_to_console = false;
         bool m_print_to_file = false;
 
@@ -98,6 +119,20 @@ namespace BCLog {
         bool OpenDebugLog();
         void ShrinkDebugFile();
 
+        /**
+         * Write the log file from a background thread, so that logging
+         * threads neither wait for each other nor for the disk. Up to
+         * queue_size messages are queued, further ones are dropped.
+         * Requires the log file to be open.
+         */
+        void StartAsyncWriter(size_t queue_size);
+        /** Write all queued messages, and go back to writing synchronously. */
+        void StopAsyncWriter();
+        /** Write all queued messages from the calling thread. */
+        void Flush();
+        /** Number of messages dropped, because the queue was full. */
+        uint64_t GetDroppedCount() const { return m_dropped.load(); }
+
         uint32_t GetCategoryMask() const { return m_categories.load(); }
 
         void EnableCategory(LogFlags flag);
@@ -6,6 +6,7 @@
 #define BITCOIN_MEMUSAGE_H
 
 #include <indirectmap.h>
+#include <support/allocators/pool.h>
 
 #include <stdlib.h>
 
@@ -72,6 +73,15 @@ private:
     X x;
 };
 
+template<typename X>
+struct stl_list_node
+{
+private:
+    void* next;
+    void* prev;
+    X x;
+};
+
 struct stl_shared_counter
 {
     /* Various platforms use different sized counters here.
@@ -165,6 +175,16 @@ static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z>& m)
     return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
+template<typename X, typename Y, typename Z, typename P, size_t MAX_BLOCK_SIZE_BYTES, size_t ALIGN_BYTES>
+static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z, P, PoolAllocator<std::pair<const X, Y>, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> >& m)
+{
+    // The nodes live in the chunks of the pool, which are kept in a list, and
+    // only the bucket array is allocated separately.
+    const PoolResource<MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>* resource = m.get_allocator().resource();
+    const size_t chunk_usage = MallocUsage(resource->ChunkSizeBytes()) + MallocUsage(sizeof(stl_list_node<void*>));
+    return chunk_usage * resource->NumAllocatedChunks() + MallocUsage(sizeof(void*) * m.bucket_count());
+}
+
 }
 
 #endif // BITCOIN_MEMUSAGE_H
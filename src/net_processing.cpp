@@ -1373,6 +1373,17 @@ bool static ProcessHeadersMessage(CNode *pfrom, CConnman *connman, const std::ve
         return true;
     }
 
+    // Hash the headers and check that they form a chain before taking cs_main
+    uint256 hashLastBlock;
+    bool headers_continuous = true;
+    for (const CBlockHeader& header : headers) {
+        if (!hashLastBlock.IsNull() && header.hashPrevBlock != hashLastBlock) {
+            headers_continuous = false;
+            break;
+        }
+        hashLastBlock = header.GetHash();
+    }
+
     bool received_new_header = false;
     const CBlockIndex *pindexLast = nullptr;
     {
@@ -1406,13 +1417,9 @@ bool static ProcessHeadersMessage(CNode *pfrom, CConnman *connman, const std::ve
             return true;
         }
 
-        uint256 hashLastBlock;
-        for (const CBlockHeader& header : headers) {
-            if (!hashLastBlock.IsNull() && header.hashPrevBlock != hashLastBlock) {
-                Misbehaving(pfrom->GetId(), 20, "non-continuous headers sequence");
-                return false;
-            }
-            hashLastBlock = header.GetHash();
+        if (!headers_continuous) {
+            Misbehaving(pfrom->GetId(), 20, "non-continuous headers sequence");
+            return false;
         }
 
         // If we don't have the last header, then they'll have given us
@@ -24,7 +24,8 @@ CMPSPInfo::Entry::Entry()
   : prop_type(0), prev_prop_id(0), num_tokens(0), property_desired(0),
     deadline(0), early_bird(0), percentage(0),
     close_early(false), max_tokens(false), missedTokens(0), timeclosed(0),
-    fixed(false), manual(false), unique(false) {}
+    fixed(false), manual(false), unique(false),
+    amount_raised(0), issuer_bonus_tokens(0) {}
 
 bool CMPSPInfo::Entry::isDivisible() const
 {
@@ -257,7 +258,15 @@ uint32_t CMPSPInfo::putSP(uint8_t ecosystem, const Entry& info)
     return propertyId;
 }
 
-bool CMPSPInfo::getSP(uint32_t propertyId, Entry& info) const
+/**
+ * Loads the entry of a property.
+ *
+ * @param propertyId  The property to lookup
+ * @param info        The entry to fill
+ * @param fHistory    Whether to load the historical data and issuers, which can be large
+ * @return True, if the entry was found
+ */
+bool CMPSPInfo::getSP(uint32_t propertyId, Entry& info, bool fHistory) const
 {
     // special cases for constant SPs MSC and TMSC
     if (OMNI_PROPERTY_MSC == propertyId) {
@@ -285,7 +294,13 @@ bool CMPSPInfo::getSP(uint32_t propertyId, Entry& info) const
 
     try {
         CDataStream ssSpValue(strSpValue.data(), strSpValue.data() + strSpValue.size(), SER_DISK, CLIENT_VERSION);
-        ssSpValue >> info;
+        if (fHistory) {
+            ssSpValue >> info;
+        } else {
+            info.SerializationOpWithoutHistory(ssSpValue, CSerActionUnserialize());
+            info.historicalData.clear();
+            info.historicalIssuers.clear();
+        }
     } catch (const std::exception& e) {
         PrintToLog("%s(): ERROR for SP %d: %s\n", __func__, propertyId, e.what());
         return false;
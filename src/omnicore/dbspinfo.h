@@ -84,6 +84,11 @@ public:
         //   txid -> granted amount, revoked amount
         std::map<uint256, std::vector<int64_t> > historicalData;
 
+        // Totals over the crowdsale participations in historicalData,
+        // stored whenever the participations of a crowdsale are stored
+        int64_t amount_raised;
+        int64_t issuer_bonus_tokens;
+
         // Historical issuers:
         //   (block, idx) -> issuer
         std::map<std::pair<int, int>, std::string > historicalIssuers;
@@ -94,6 +99,14 @@ public:
 
         template <typename Stream, typename Operation>
         inline void SerializationOp(Stream& s, Operation ser_action) {
+            SerializationOpWithoutHistory(s, ser_action);
+            READWRITE(historicalData);
+            READWRITE(historicalIssuers);
+        }
+
+        /** Serializes all fields, but the historical data and issuers, which are stored last. */
+        template <typename Stream, typename Operation>
+        inline void SerializationOpWithoutHistory(Stream& s, Operation ser_action) {
             READWRITE(issuer);
             READWRITE(prop_type);
             READWRITE(prev_prop_id);
@@ -118,8 +131,8 @@ public:
             READWRITE(fixed);
             READWRITE(manual);
             READWRITE(unique);
-            READWRITE(historicalData);
-            READWRITE(historicalIssuers);
+            READWRITE(amount_raised);
+            READWRITE(issuer_bonus_tokens);
         }
 
         bool isDivisible() const;
@@ -152,7 +165,7 @@ public:
     uint32_t peekNextSPID(uint8_t ecosystem) const;
     bool updateSP(uint32_t propertyId, const Entry& info);
     uint32_t putSP(uint8_t ecosystem, const Entry& info);
-    bool getSP(uint32_t propertyId, Entry& info) const;
+    bool getSP(uint32_t propertyId, Entry& info, bool fHistory = true) const;
     bool hasSP(uint32_t propertyId) const;
     uint32_t findSPByTX(const uint256& txid) const;
 
@@ -22,6 +22,7 @@
 #include <leveldb/iterator.h>
 #include <leveldb/slice.h>
 #include <leveldb/status.h>
+#include <leveldb/write_batch.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
@@ -30,6 +31,7 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -43,10 +45,21 @@ using mastercore::GetBlockIndex;
 using mastercore::isNonMainNet;
 using mastercore::pDbTransaction;
 
+//! Key of the total number of transaction records
+static const std::string TXCOUNT_TOTAL_KEY = "txcount";
+//! Prefix of the keys of the number of transaction records per block
+static const std::string TXCOUNT_BLOCK_PREFIX = "txcount-";
+
 CMPTxList::CMPTxList(const fs::path& path, bool fWipe)
 {
     leveldb::Status status = Open(path, fWipe);
     PrintToConsole("Loading tx meta-info database: %s\n", status.ToString());
+
+    // databases created before the counters were introduced are counted once
+    std::string strValue;
+    if (status.ok() && pdb->Get(readoptions, TXCOUNT_TOTAL_KEY, &strValue).IsNotFound()) {
+        RebuildTxCounts();
+    }
 }
 
 CMPTxList::~CMPTxList()
@@ -69,7 +82,10 @@ void CMPTxList::recordTX(const uint256 &txid, bool fValid, int nBlock, unsigned
     PrintToLog("%s(%s, valid=%s, block= %d, type= %d, value= %lu)\n",
             __func__, txid.ToString(), fValid ? "YES" : "NO", nBlock, type, nValue);
 
-    status = pdb->Put(writeoptions, key, value);
+    leveldb::WriteBatch batch;
+    batch.Put(key, value);
+    CountRecord(batch, key, nBlock);
+    status = pdb->Write(writeoptions, &batch);
     ++nWritten;
 }
 
@@ -111,7 +127,10 @@ void CMPTxList::recordPaymentTX(const uint256& txid, bool fValid, int nBlock, un
     const std::string value = strprintf("%u:%d:%u:%lu", fValid ? 1 : 0, nBlock, type, numberOfPayments);
     leveldb::Status status;
     PrintToLog("DEXPAYDEBUG : Writing master record %s(%s, valid=%s, block= %d, type= %d, number of payments= %lu)\n", __func__, txid.ToString(), fValid ? "YES" : "NO", nBlock, type, numberOfPayments);
-    status = pdb->Put(writeoptions, key, value);
+    leveldb::WriteBatch batch;
+    batch.Put(key, value);
+    CountRecord(batch, key, nBlock);
+    status = pdb->Write(writeoptions, &batch);
 
     // Step 4 - Write sub-record with payment details
     const std::string txidStr = txid.ToString();
@@ -210,42 +229,150 @@ bool CMPTxList::getSendAllDetails(const uint256& txid, int subSend, uint32_t& pr
     return false;
 }
 
-int CMPTxList::getMPTransactionCountTotal()
+/**
+ * Reads a transaction counter.
+ *
+ * @param key  The key of the counter
+ * @return The number of transactions, or 0, if there is no counter
+ */
+int CMPTxList::ReadTxCount(const std::string& key)
 {
-    int count = 0;
-    leveldb::Slice skey, svalue;
-    leveldb::Iterator* it = NewIterator();
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        skey = it->key();
-        if (skey.ToString().length() == 64) {
-            ++count;
-        } //extra entries for cancels and purchases are more than 64 chars long
+    std::string strValue;
+    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    if (!status.ok()) {
+        return 0;
     }
-    delete it;
-    return count;
+    return atoi(strValue);
 }
 
-int CMPTxList::getMPTransactionCountBlock(int block)
+/**
+ * Returns the block of a transaction record.
+ *
+ * Only records with txid keys are counted, extra entries for cancels and
+ * purchases have longer keys.
+ *
+ * @param key     The key of the record
+ * @param value   The value of the record
+ * @param nBlock  The block of the record
+ * @return True, if the entry is a transaction record
+ */
+static bool ParseRecordBlock(const std::string& key, const std::string& value, int& nBlock)
 {
-    int count = 0;
-    leveldb::Slice skey, svalue;
+    if (key.length() != 64) {
+        return false;
+    }
+    std::vector<std::string> vstr;
+    boost::split(vstr, value, boost::is_any_of(":"), boost::token_compress_on);
+    if (4 != vstr.size()) {
+        return false;
+    }
+    nBlock = atoi(vstr[1]);
+    return true;
+}
+
+/**
+ * Adds the update of the transaction counters to a batch.
+ *
+ * @param batch        The batch to add the updated counters to
+ * @param nTotalDelta  The change of the total number of transactions
+ * @param blockDeltas  The changes of the number of transactions per block
+ */
+void CMPTxList::WriteTxCounts(leveldb::WriteBatch& batch, int nTotalDelta, const std::map<int, int>& blockDeltas)
+{
+    for (std::map<int, int>::const_iterator it = blockDeltas.begin(); it != blockDeltas.end(); ++it) {
+        if (it->second == 0) continue;
+        const std::string key = TXCOUNT_BLOCK_PREFIX + strprintf("%d", it->first);
+        int count = ReadTxCount(key) + it->second;
+        if (count > 0) {
+            batch.Put(key, strprintf("%d", count));
+        } else {
+            batch.Delete(key);
+        }
+    }
+    if (nTotalDelta != 0) {
+        batch.Put(TXCOUNT_TOTAL_KEY, strprintf("%d", ReadTxCount(TXCOUNT_TOTAL_KEY) + nTotalDelta));
+    }
+}
+
+/**
+ * Adds the counter updates for a transaction record, which is about to be
+ * written, to a batch.
+ *
+ * An existing record is replaced, so it is already part of the total, and
+ * no longer counted for its old block.
+ *
+ * @param batch   The batch, which writes the record
+ * @param key     The key of the record
+ * @param nBlock  The block of the new record
+ */
+void CMPTxList::CountRecord(leveldb::WriteBatch& batch, const std::string& key, int nBlock)
+{
+    int nTotalDelta = 1;
+    std::map<int, int> blockDeltas;
+
+    std::string strValue;
+    int nBlockPrev = 0;
+    leveldb::Status status = pdb->Get(readoptions, key, &strValue);
+    if (status.ok() && key.length() == 64) {
+        nTotalDelta = 0;
+        if (ParseRecordBlock(key, strValue, nBlockPrev)) {
+            --blockDeltas[nBlockPrev];
+        }
+    }
+    ++blockDeltas[nBlock];
+
+    WriteTxCounts(batch, nTotalDelta, blockDeltas);
+}
+
+/**
+ * Counts all transaction records and stores the counters.
+ */
+void CMPTxList::RebuildTxCounts()
+{
+    int nTotal = 0;
+    std::map<int, int> blockCounts;
+    leveldb::WriteBatch batch;
     leveldb::Iterator* it = NewIterator();
+
     for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        skey = it->key();
-        svalue = it->value();
-        if (skey.ToString().length() == 64) {
-            std::string strValue = svalue.ToString();
-            std::vector<std::string> vstr;
-            boost::split(vstr, strValue, boost::is_any_of(":"), boost::token_compress_on);
-            if (4 == vstr.size()) {
-                if (atoi(vstr[1]) == block) {
-                    ++count;
-                }
-            }
+        const std::string key = it->key().ToString();
+        if (key.compare(0, TXCOUNT_BLOCK_PREFIX.size(), TXCOUNT_BLOCK_PREFIX) == 0) {
+            batch.Delete(key);
+            continue;
+        }
+        if (key.length() != 64) continue;
+        ++nTotal;
+        int nBlock = 0;
+        if (ParseRecordBlock(key, it->value().ToString(), nBlock)) {
+            ++blockCounts[nBlock];
         }
     }
+
     delete it;
-    return count;
+
+    for (std::map<int, int>::const_iterator it = blockCounts.begin(); it != blockCounts.end(); ++it) {
+        batch.Put(TXCOUNT_BLOCK_PREFIX + strprintf("%d", it->first), strprintf("%d", it->second));
+    }
+    batch.Put(TXCOUNT_TOTAL_KEY, strprintf("%d", nTotal));
+
+    leveldb::Status status = pdb->Write(writeoptions, &batch);
+    PrintToLog("%s(): counted %d transactions in %d blocks: %s\n", __func__, nTotal, blockCounts.size(), status.ToString());
+}
+
+/**
+ * Returns the total number of transaction records.
+ */
+int CMPTxList::getMPTransactionCountTotal()
+{
+    return ReadTxCount(TXCOUNT_TOTAL_KEY);
+}
+
+/**
+ * Returns the number of transaction records of a block.
+ */
+int CMPTxList::getMPTransactionCountBlock(int block)
+{
+    return ReadTxCount(TXCOUNT_BLOCK_PREFIX + strprintf("%d", block));
 }
 
 /** Returns a list of all Omni transactions in the given block range. */
@@ -690,6 +817,9 @@ bool CMPTxList::isMPinBlockRange(int starting_block, int ending_block, bool bDel
     std::vector<std::string> vstr;
     int block;
     unsigned int n_found = 0;
+    int nTotalDelta = 0;
+    std::map<int, int> blockDeltas;
+    leveldb::WriteBatch batch;
 
     leveldb::Iterator* it = NewIterator();
 
@@ -711,11 +841,27 @@ bool CMPTxList::isMPinBlockRange(int starting_block, int ending_block, bool bDel
             if ((starting_block <= block) && (block <= ending_block)) {
                 ++n_found;
                 PrintToLog("%s() DELETING: %s=%s\n", __func__, skey.ToString(), svalue.ToString());
-                if (bDeleteFound) pdb->Delete(writeoptions, skey);
+                if (bDeleteFound) {
+                    const std::string strkey = skey.ToString();
+                    int nRecordBlock = 0;
+                    if (strkey.length() == 64) {
+                        --nTotalDelta;
+                    }
+                    if (ParseRecordBlock(strkey, strvalue, nRecordBlock)) {
+                        --blockDeltas[nRecordBlock];
+                    }
+                    batch.Delete(skey);
+                }
             }
         }
     }
 
+    // the records and the counters are updated atomically
+    if (bDeleteFound) {
+        WriteTxCounts(batch, nTotalDelta, blockDeltas);
+        pdb->Write(writeoptions, &batch);
+    }
+
     PrintToLog("%s(%d, %d); n_found= %d\n", __func__, starting_block, ending_block, n_found);
 
     delete it;
@@ -9,9 +9,15 @@
 
 #include <stdint.h>
 
+#include <map>
 #include <set>
 #include <string>
 
+namespace leveldb
+{
+class WriteBatch;
+}
+
 /** LevelDB based storage for transactions, with txid as key and validity bit, and other data as value.
  */
 class CMPTxList : public CDBBase
@@ -57,6 +63,16 @@ public:
     void printAll();
 
     bool isMPinBlockRange(int, int, bool);
+
+private:
+    /** Reads a transaction counter. */
+    int ReadTxCount(const std::string& key);
+    /** Adds the update of the transaction counters to a batch. */
+    void WriteTxCounts(leveldb::WriteBatch& batch, int nTotalDelta, const std::map<int, int>& blockDeltas);
+    /** Adds the counter updates for a transaction record, which is about to be written, to a batch. */
+    void CountRecord(leveldb::WriteBatch& batch, const std::string& key, int nBlock);
+    /** Counts all transaction records and stores the counters. */
+    void RebuildTxCounts();
 };
 
 namespace mastercore
@@ -24,6 +24,7 @@
 #include <omnicore/script.h>
 #include <omnicore/sp.h>
 #include <omnicore/tally.h>
+#include <omnicore/tallysnapshot.h>
 #include <omnicore/tx.h>
 #include <omnicore/utilsbitcoin.h>
 #include <omnicore/utilsui.h>
@@ -127,6 +128,11 @@ std::set<std::pair<std::string,uint32_t> > setFrozenAddresses;
 //! In-memory collection of all amounts for all addresses for all properties
 std::unordered_map<std::string, CMPTally> mastercore::mp_tally_map;
 
+//! Addresses with balance changes since the last published snapshot
+static std::set<std::string> setTallyChanged;
+//! Flag to indicate whether all balances were dropped since the last published snapshot
+static bool fTallyCleared = true;
+
 // Only needed for GUI:
 
 //! Available balances of wallet properties
@@ -258,34 +264,18 @@ int64_t GetTokenBalance(const std::string& address, uint32_t propertyId, TallyTy
 
 int64_t GetAvailableTokenBalance(const std::string& address, uint32_t propertyId)
 {
-    int64_t money = GetTokenBalance(address, propertyId, BALANCE);
-    int64_t pending = GetTokenBalance(address, propertyId, PENDING);
-
-    if (0 > pending) {
-        return (money + pending); // show the decrease in available money
-    }
-
-    return money;
+    return GetAvailableBalance([&](TallyType ttype) { return GetTokenBalance(address, propertyId, ttype); });
 }
 
 int64_t GetReservedTokenBalance(const std::string& address, uint32_t propertyId)
 {
-    int64_t nReserved = 0;
-    nReserved += GetTokenBalance(address, propertyId, ACCEPT_RESERVE);
-    nReserved += GetTokenBalance(address, propertyId, SELLOFFER_RESERVE);
-
-    return nReserved;
+    return GetReservedBalance([&](TallyType ttype) { return GetTokenBalance(address, propertyId, ttype); });
 }
 
 int64_t GetFrozenTokenBalance(const std::string& address, uint32_t propertyId)
 {
-    int64_t frozen = 0;
-
-    if (isAddressFrozen(address, propertyId)) {
-        frozen = GetTokenBalance(address, propertyId, BALANCE);
-    }
-
-    return frozen;
+    return GetFrozenBalance([&](TallyType ttype) { return GetTokenBalance(address, propertyId, ttype); },
+            isAddressFrozen(address, propertyId));
 }
 
 bool mastercore::isTestEcosystemProperty(uint32_t propertyId)
@@ -443,6 +433,101 @@ int64_t mastercore::getTotalTokens(uint32_t propertyId, int64_t* n_owners_total)
     return totalTokens;
 }
 
+void mastercore::ClearTallyMap()
+{
+    LOCK(cs_tally);
+
+    mp_tally_map.clear();
+    setTallyChanged.clear();
+    fTallyCleared = true;
+}
+
+/**
+ * Publishes the current balances as new snapshot.
+ *
+ * Only the shards of the previous snapshot with changed addresses are copied,
+ * all other shards are shared with the previous snapshot.
+ *
+ * @param nBlock  The block height of the state
+ */
+void mastercore::PublishTallySnapshot(int nBlock)
+{
+    AssertLockHeld(cs_tally);
+
+    std::shared_ptr<const CMPTallySnapshot> prev = GetTallySnapshot();
+    std::shared_ptr<CMPTallySnapshot> snapshot = std::make_shared<CMPTallySnapshot>();
+    snapshot->nBlock = nBlock;
+    snapshot->nNextSPID[0] = pDbSpInfo ? pDbSpInfo->peekNextSPID(OMNI_PROPERTY_MSC) : 0;
+    snapshot->nNextSPID[1] = pDbSpInfo ? pDbSpInfo->peekNextSPID(OMNI_PROPERTY_TMSC) : 0;
+    snapshot->frozenAddresses = std::make_shared<const CMPTallySnapshot::FrozenSet>(setFrozenAddresses);
+
+    if (fTallyCleared) {
+        std::array<CMPTallySnapshot::TallyShard, CMPTallySnapshot::SHARD_COUNT> shards;
+        for (std::unordered_map<std::string, CMPTally>::const_iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
+            shards[CMPTallySnapshot::GetShard(it->first)].emplace(it->first, std::make_shared<const CMPTally>(it->second));
+        }
+        for (size_t i = 0; i < CMPTallySnapshot::SHARD_COUNT; ++i) {
+            snapshot->shards[i] = std::make_shared<const CMPTallySnapshot::TallyShard>(std::move(shards[i]));
+        }
+    } else {
+        snapshot->shards = prev->shards;
+
+        std::map<size_t, std::shared_ptr<CMPTallySnapshot::TallyShard> > changedShards;
+        for (const std::string& address : setTallyChanged) {
+            size_t i = CMPTallySnapshot::GetShard(address);
+            std::shared_ptr<CMPTallySnapshot::TallyShard>& shard = changedShards[i];
+            if (!shard) {
+                shard = std::make_shared<CMPTallySnapshot::TallyShard>(*prev->shards[i]);
+            }
+            std::unordered_map<std::string, CMPTally>::const_iterator it = mp_tally_map.find(address);
+            if (it != mp_tally_map.end()) {
+                (*shard)[address] = std::make_shared<const CMPTally>(it->second);
+            } else {
+                shard->erase(address);
+            }
+        }
+        for (const auto& item : changedShards) {
+            snapshot->shards[item.first] = item.second;
+        }
+    }
+
+    setTallyChanged.clear();
+    fTallyCleared = false;
+
+    SetTallySnapshot(std::move(snapshot));
+}
+
+/**
+ * Publishes a copy of the current snapshot, where only the pending balance
+ * of one address is changed.
+ *
+ * Pending transactions are added outside of block processing, where the
+ * balances may only be partially updated by a block, so they are not taken
+ * from the tally map. The change is also part of the tally map, and therefore
+ * part of the next snapshot published by PublishTallySnapshot().
+ *
+ * @param address     The address of the pending transaction
+ * @param propertyId  The property of the pending transaction
+ * @param amount      The change of the pending balance
+ */
+void mastercore::PublishPendingBalance(const std::string& address, uint32_t propertyId, int64_t amount)
+{
+    AssertLockHeld(cs_tally);
+
+    std::shared_ptr<const CMPTallySnapshot> prev = GetTallySnapshot();
+    std::shared_ptr<CMPTallySnapshot> snapshot = std::make_shared<CMPTallySnapshot>(*prev);
+
+    const size_t i = CMPTallySnapshot::GetShard(address);
+    std::shared_ptr<CMPTallySnapshot::TallyShard> shard = std::make_shared<CMPTallySnapshot::TallyShard>(*prev->shards[i]);
+    const CMPTally* prevTally = prev->getTally(address);
+    std::shared_ptr<CMPTally> tally = prevTally ? std::make_shared<CMPTally>(*prevTally) : std::make_shared<CMPTally>();
+    tally->updateMoney(propertyId, amount, PENDING);
+    (*shard)[address] = std::move(tally);
+    snapshot->shards[i] = std::move(shard);
+
+    SetTallySnapshot(std::move(snapshot));
+}
+
 // return true if everything is ok
 bool mastercore::update_tally_map(const std::string& who, uint32_t propertyId, int64_t amount, TallyType ttype)
 {
@@ -475,6 +560,7 @@ bool mastercore::update_tally_map(const std::string& who, uint32_t propertyId, i
 
     CMPTally& tally = my_it->second;
     bRet = tally.updateMoney(propertyId, amount, ttype);
+    setTallyChanged.insert(who);
 
     after = GetTokenBalance(who, propertyId, ttype);
     if (!bRet) {
@@ -1436,7 +1522,7 @@ void clear_all_state()
     LOCK2(cs_tally, cs_pending);
 
     // Memory based storage
-    mp_tally_map.clear();
+    ClearTallyMap();
     my_offers.clear();
     my_accepts.clear();
     my_crowds.clear();
@@ -1660,6 +1746,11 @@ int mastercore_init()
     // initial scan
     msc_initial_scan(nWaterline);
 
+    {
+        LOCK(cs_tally);
+        PublishTallySnapshot(GetHeight());
+    }
+
     PrintToConsole("Omni Core initialization completed\n");
 
     return 0;
@@ -1700,6 +1791,8 @@ int mastercore_shutdown()
 
     mastercoreInitialized = 0;
 
+    SetTallySnapshot(std::make_shared<const CMPTallySnapshot>());
+
     PrintToLog("\nOmni Core shutdown completed\n");
     PrintToLog("Shutdown time: %s\n", FormatISO8601DateTime(GetTime()));
 
@@ -1902,6 +1995,9 @@ int mastercore_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
         }
     }
 
+    // make the balances after this block visible to readers without cs_tally
+    PublishTallySnapshot(nBlockNow);
+
     return 0;
 }
 
@@ -38,7 +38,7 @@ int const DONT_STORE_MAINNET_STATE_UNTIL = 622000;
 #define TEST_ECO_PROPERTY_1 (0x80000003UL)
 
 // increment this value to force a refresh of the state (similar to --startclean)
-#define DB_VERSION 8
+#define DB_VERSION 9
 
 // could probably also use: int64_t maxInt64 = std::numeric_limits<int64_t>::max();
 // maximum numeric values from the spec:
@@ -193,6 +193,12 @@ uint32_t GetNextPropertyId(bool maineco); // maybe move into sp
 
 CMPTally* getTally(const std::string& address);
 bool update_tally_map(const std::string& who, uint32_t propertyId, int64_t amount, TallyType ttype);
+/** Removes the balances of all addresses. */
+void ClearTallyMap();
+/** Publishes the current balances as snapshot, which can be read without cs_tally. */
+void PublishTallySnapshot(int nBlock);
+/** Publishes a copy of the current snapshot, where only the pending balance of one address is changed. */
+void PublishPendingBalance(const std::string& address, uint32_t propertyId, int64_t amount);
 int64_t getTotalTokens(uint32_t propertyId, int64_t* n_owners_total = nullptr);
 
 std::string strMPProperty(uint32_t propertyId);
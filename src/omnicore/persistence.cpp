@@ -504,7 +504,7 @@ int RestoreInMemoryState(const std::string& filename, int what, bool verifyHash)
 
     switch (what) {
         case FILETYPE_BALANCES:
-            mp_tally_map.clear();
+            ClearTallyMap();
             inputLineFunc = input_msc_balances_string;
             break;
 
@@ -25,6 +25,7 @@
 #include <omnicore/sp.h>
 #include <omnicore/sto.h>
 #include <omnicore/tally.h>
+#include <omnicore/tallysnapshot.h>
 #include <omnicore/tx.h>
 #include <omnicore/nftdb.h>
 #include <omnicore/utilsbitcoin.h>
@@ -56,7 +57,9 @@
 #include <univalue.h>
 
 #include <stdint.h>
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -109,12 +112,12 @@ void PropertyToJSON(const CMPSPInfo::Entry& sProperty, UniValue& property_obj)
     property_obj.pushKV("non-fungibletoken", sProperty.unique);
 }
 
-bool BalanceToJSON(const std::string& address, uint32_t property, UniValue& balance_obj, bool divisible)
+bool BalanceToJSON(const CMPTallySnapshot& snapshot, const std::string& address, uint32_t property, UniValue& balance_obj, bool divisible)
 {
     // confirmed balance minus unconfirmed, spent amounts
-    int64_t nAvailable = GetAvailableTokenBalance(address, property);
-    int64_t nReserved = GetReservedTokenBalance(address, property);
-    int64_t nFrozen = GetFrozenTokenBalance(address, property);
+    int64_t nAvailable = snapshot.getAvailableTokenBalance(address, property);
+    int64_t nReserved = snapshot.getReservedTokenBalance(address, property);
+    int64_t nFrozen = snapshot.getFrozenTokenBalance(address, property);
 
     if (divisible) {
         balance_obj.pushKV("balance", FormatDivisibleMP(nAvailable));
@@ -592,10 +595,13 @@ static UniValue omni_getbalance(const JSONRPCRequest& request)
     std::string address = ParseAddress(request.params[0]);
     uint32_t propertyId = ParsePropertyId(request.params[1]);
 
-    RequireExistingProperty(propertyId);
+    // balances are read from the last published state, without blocking on cs_tally
+    std::shared_ptr<const CMPTallySnapshot> snapshot = GetTallySnapshot();
+
+    RequireExistingProperty(*snapshot, propertyId);
 
     UniValue balanceObj(UniValue::VOBJ);
-    BalanceToJSON(address, propertyId, balanceObj, isPropertyDivisible(propertyId));
+    BalanceToJSON(*snapshot, address, propertyId, balanceObj, isPropertyDivisible(propertyId));
 
     return balanceObj;
 }
@@ -628,33 +634,27 @@ static UniValue omni_getallbalancesforid(const JSONRPCRequest& request)
 
     uint32_t propertyId = ParsePropertyId(request.params[0]);
 
-    RequireExistingProperty(propertyId);
+    std::shared_ptr<const CMPTallySnapshot> snapshot = GetTallySnapshot();
+
+    RequireExistingProperty(*snapshot, propertyId);
 
     UniValue response(UniValue::VARR);
     bool isDivisible = isPropertyDivisible(propertyId); // we want to check this BEFORE the loop
 
-    LOCK(cs_tally);
-
-    for (std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-        uint32_t id = 0;
-        bool includeAddress = false;
-        std::string address = it->first;
-        (it->second).init();
-        while (0 != (id = (it->second).next())) {
-            if (id == propertyId) {
-                includeAddress = true;
-                break;
+    for (const auto& shard : snapshot->shards) {
+        for (CMPTallySnapshot::TallyShard::const_iterator it = shard->begin(); it != shard->end(); ++it) {
+            const std::string& address = it->first;
+            std::vector<uint32_t> propertyIds = it->second->getPropertyIds();
+            if (!std::binary_search(propertyIds.begin(), propertyIds.end(), propertyId)) {
+                continue; // ignore this address, has never transacted in this propertyId
             }
-        }
-        if (!includeAddress) {
-            continue; // ignore this address, has never transacted in this propertyId
-        }
-        UniValue balanceObj(UniValue::VOBJ);
-        balanceObj.pushKV("address", address);
-        bool nonEmptyBalance = BalanceToJSON(address, propertyId, balanceObj, isDivisible);
+            UniValue balanceObj(UniValue::VOBJ);
+            balanceObj.pushKV("address", address);
+            bool nonEmptyBalance = BalanceToJSON(*snapshot, address, propertyId, balanceObj, isDivisible);
 
-        if (nonEmptyBalance) {
-            response.push_back(balanceObj);
+            if (nonEmptyBalance) {
+                response.push_back(balanceObj);
+            }
         }
     }
 
@@ -692,18 +692,15 @@ static UniValue omni_getallbalancesforaddress(const JSONRPCRequest& request)
 
     UniValue response(UniValue::VARR);
 
-    LOCK(cs_tally);
+    std::shared_ptr<const CMPTallySnapshot> snapshot = GetTallySnapshot();
 
-    CMPTally* addressTally = getTally(address);
+    const CMPTally* addressTally = snapshot->getTally(address);
 
     if (nullptr == addressTally) { // addressTally object does not exist
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Address not found");
     }
 
-    addressTally->init();
-
-    uint32_t propertyId = 0;
-    while (0 != (propertyId = addressTally->next())) {
+    for (uint32_t propertyId : addressTally->getPropertyIds()) {
         CMPSPInfo::Entry property;
         if (!pDbSpInfo->getSP(propertyId, property)) {
             continue;
@@ -713,7 +710,7 @@ static UniValue omni_getallbalancesforaddress(const JSONRPCRequest& request)
         balanceObj.pushKV("propertyid", (uint64_t) propertyId);
         balanceObj.pushKV("name", property.name);
 
-        bool nonEmptyBalance = BalanceToJSON(address, propertyId, balanceObj, property.isDivisible());
+        bool nonEmptyBalance = BalanceToJSON(*snapshot, address, propertyId, balanceObj, property.isDivisible());
 
         if (nonEmptyBalance) {
             response.push_back(balanceObj);
@@ -794,20 +791,17 @@ static UniValue omni_getwalletbalances(const JSONRPCRequest& request)
     std::set<std::string> addresses = getWalletAddresses(request, fIncludeWatchOnly);
     std::map<uint32_t, std::tuple<int64_t, int64_t, int64_t>> balances;
 
-    LOCK(cs_tally);
+    std::shared_ptr<const CMPTallySnapshot> snapshot = GetTallySnapshot();
     for(const std::string& address : addresses) {
-        CMPTally* addressTally = getTally(address);
+        const CMPTally* addressTally = snapshot->getTally(address);
         if (nullptr == addressTally) {
             continue; // address doesn't have tokens
         }
 
-        uint32_t propertyId = 0;
-        addressTally->init();
-
-        while (0 != (propertyId = addressTally->next())) {
-            int64_t nAvailable = GetAvailableTokenBalance(address, propertyId);
-            int64_t nReserved = GetReservedTokenBalance(address, propertyId);
-            int64_t nFrozen = GetFrozenTokenBalance(address, propertyId);
+        for (uint32_t propertyId : addressTally->getPropertyIds()) {
+            int64_t nAvailable = snapshot->getAvailableTokenBalance(address, propertyId);
+            int64_t nReserved = snapshot->getReservedTokenBalance(address, propertyId);
+            int64_t nFrozen = snapshot->getFrozenTokenBalance(address, propertyId);
 
             if (!nAvailable && !nReserved && !nFrozen) {
                 continue;
@@ -912,18 +906,16 @@ static UniValue omni_getwalletaddressbalances(const JSONRPCRequest& request)
 
     std::set<std::string> addresses = getWalletAddresses(request, fIncludeWatchOnly);
 
-    LOCK(cs_tally);
+    std::shared_ptr<const CMPTallySnapshot> snapshot = GetTallySnapshot();
     for(const std::string& address : addresses) {
-        CMPTally* addressTally = getTally(address);
+        const CMPTally* addressTally = snapshot->getTally(address);
         if (nullptr == addressTally) {
             continue; // address doesn't have tokens
         }
 
         UniValue arrBalances(UniValue::VARR);
-        uint32_t propertyId = 0;
-        addressTally->init();
 
-        while (0 != (propertyId = addressTally->next())) {
+        for (uint32_t propertyId : addressTally->getPropertyIds()) {
             CMPSPInfo::Entry property;
             if (!pDbSpInfo->getSP(propertyId, property)) {
                 continue; // token wasn't found in the DB
@@ -933,7 +925,7 @@ static UniValue omni_getwalletaddressbalances(const JSONRPCRequest& request)
             objBalance.pushKV("propertyid", (uint64_t) propertyId);
             objBalance.pushKV("name", property.name);
 
-            bool nonEmptyBalance = BalanceToJSON(address, propertyId, objBalance, property.isDivisible());
+            bool nonEmptyBalance = BalanceToJSON(*snapshot, address, propertyId, objBalance, property.isDivisible());
 
             if (nonEmptyBalance) {
                 arrBalances.push_back(objBalance);
@@ -1128,10 +1120,11 @@ static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
     RequireExistingProperty(propertyId);
     RequireCrowdsale(propertyId);
 
+    // the participations are only loaded, when they are requested
     CMPSPInfo::Entry sp;
     {
         LOCK(cs_tally);
-        if (!pDbSpInfo->getSP(propertyId, sp)) {
+        if (!pDbSpInfo->getSP(propertyId, sp, showVerbose)) {
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Property identifier does not exist");
         }
     }
@@ -1155,6 +1148,8 @@ static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
 
     UniValue response(UniValue::VOBJ);
     bool active = isCrowdsaleActive(propertyId);
+    int64_t amountRaised = 0;
+    int64_t amountIssuerTokens = 0;
     std::map<uint256, std::vector<int64_t> > database;
 
     if (active) {
@@ -1166,14 +1161,18 @@ static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
             const CMPCrowd& crowd = it->second;
             if (propertyId == crowd.getPropertyId()) {
                 crowdFound = true;
-                database = crowd.getDatabase();
+                amountRaised = crowd.getAmountRaised();
+                amountIssuerTokens = crowd.getIssuerBonusTokens();
+                if (showVerbose) database = crowd.getDatabase();
             }
         }
         if (!crowdFound) {
             throw JSONRPCError(RPC_INTERNAL_ERROR, "Crowdsale is flagged active but cannot be retrieved");
         }
     } else {
-        database = sp.historicalData;
+        amountRaised = sp.amount_raised;
+        amountIssuerTokens = sp.issuer_bonus_tokens;
+        if (showVerbose) database.swap(sp.historicalData);
     }
 
     int64_t tokensIssued = getTotalTokens(propertyId);
@@ -1184,25 +1183,6 @@ static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
         startTime = GetBlockIndex(hashBlock)->nTime;
     }
 
-    // note the database is already deserialized here and there is minimal performance penalty to iterate recipients to calculate amountRaised
-    int64_t amountRaised = 0;
-    int64_t amountIssuerTokens = 0;
-    uint16_t propertyIdType = isPropertyDivisible(propertyId) ? MSC_PROPERTY_TYPE_DIVISIBLE : MSC_PROPERTY_TYPE_INDIVISIBLE;
-    uint16_t desiredIdType = isPropertyDivisible(sp.property_desired) ? MSC_PROPERTY_TYPE_DIVISIBLE : MSC_PROPERTY_TYPE_INDIVISIBLE;
-    std::map<std::string, UniValue> sortMap;
-    for (std::map<uint256, std::vector<int64_t> >::const_iterator it = database.begin(); it != database.end(); it++) {
-        UniValue participanttx(UniValue::VOBJ);
-        std::string txid = it->first.GetHex();
-        amountRaised += it->second.at(0);
-        amountIssuerTokens += it->second.at(3);
-        participanttx.pushKV("txid", txid);
-        participanttx.pushKV("amountsent", FormatByType(it->second.at(0), desiredIdType));
-        participanttx.pushKV("participanttokens", FormatByType(it->second.at(2), propertyIdType));
-        participanttx.pushKV("issuertokens", FormatByType(it->second.at(3), propertyIdType));
-        std::string sortKey = strprintf("%d-%s", it->second.at(1), txid);
-        sortMap.insert(std::make_pair(sortKey, participanttx));
-    }
-
     response.pushKV("propertyid", (uint64_t) propertyId);
     response.pushKV("name", sp.name);
     response.pushKV("active", active);
@@ -1224,7 +1204,22 @@ static UniValue omni_getcrowdsale(const JSONRPCRequest& request)
     if (sp.close_early) response.pushKV("endedtime", sp.timeclosed);
     if (sp.close_early && !sp.max_tokens) response.pushKV("closetx", txidClosed);
 
+    // participations are only formatted, when they are requested
     if (showVerbose) {
+        uint16_t propertyIdType = isPropertyDivisible(propertyId) ? MSC_PROPERTY_TYPE_DIVISIBLE : MSC_PROPERTY_TYPE_INDIVISIBLE;
+        uint16_t desiredIdType = isPropertyDivisible(sp.property_desired) ? MSC_PROPERTY_TYPE_DIVISIBLE : MSC_PROPERTY_TYPE_INDIVISIBLE;
+        std::map<std::string, UniValue> sortMap;
+        for (std::map<uint256, std::vector<int64_t> >::const_iterator it = database.begin(); it != database.end(); it++) {
+            UniValue participanttx(UniValue::VOBJ);
+            std::string txid = it->first.GetHex();
+            participanttx.pushKV("txid", txid);
+            participanttx.pushKV("amountsent", FormatByType(it->second.at(0), desiredIdType));
+            participanttx.pushKV("participanttokens", FormatByType(it->second.at(2), propertyIdType));
+            participanttx.pushKV("issuertokens", FormatByType(it->second.at(3), propertyIdType));
+            std::string sortKey = strprintf("%d-%s", it->second.at(1), txid);
+            sortMap.insert(std::make_pair(sortKey, participanttx));
+        }
+
         UniValue participanttxs(UniValue::VARR);
         for (std::map<std::string, UniValue>::iterator it = sortMap.begin(); it != sortMap.end(); ++it) {
             participanttxs.push_back(it->second);
@@ -1266,6 +1261,11 @@ static UniValue omni_getactivecrowdsales(const JSONRPCRequest& request)
 
     UniValue response(UniValue::VARR);
 
+    bool f_txindex_ready = false;
+    if (g_txindex) {
+        f_txindex_ready = g_txindex->BlockUntilSyncedToCurrentChain();
+    }
+
     LOCK2(cs_main, cs_tally);
 
     for (CrowdMap::const_iterator it = my_crowds.begin(); it != my_crowds.end(); ++it) {
@@ -1279,11 +1279,6 @@ static UniValue omni_getactivecrowdsales(const JSONRPCRequest& request)
 
         const uint256& creationHash = sp.txid;
 
-        bool f_txindex_ready = false;
-        if (g_txindex) {
-            f_txindex_ready = g_txindex->BlockUntilSyncedToCurrentChain();
-        }
-
         CTransactionRef tx;
         uint256 hashBlock;
         if (!GetTransaction(creationHash, tx, Params().GetConsensus(), hashBlock)) {
@@ -100,11 +100,11 @@ static UniValue omni_decodetransaction(const JSONRPCRequest& request)
     {
         LOCK2(cs_main, cs_tx_cache);
         // temporarily switch global coins view cache for transaction inputs
-        std::swap(view, viewTemp);
+        view.Swap(viewTemp);
         // then get the results
         populateResult = populateRPCTransactionObject(tx, uint256(), txObj, "", false, "", blockHeight, pWallet.get());
         // and restore the original, unpolluted coins view cache
-        std::swap(viewTemp, view);
+        viewTemp.Swap(view);
     }
 
     if (populateResult != 0) PopulateFailure(populateResult);
@@ -4,6 +4,7 @@
 #include <omnicore/dex.h>
 #include <omnicore/omnicore.h>
 #include <omnicore/sp.h>
+#include <omnicore/tallysnapshot.h>
 #include <omnicore/nftdb.h>
 #include <omnicore/utilsbitcoin.h>
 
@@ -50,6 +51,13 @@ void RequireExistingProperty(uint32_t propertyId)
     }
 }
 
+void RequireExistingProperty(const mastercore::CMPTallySnapshot& snapshot, uint32_t propertyId)
+{
+    if (!snapshot.isPropertyIdValid(propertyId)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Property identifier does not exist");
+    }
+}
+
 void RequireSameEcosystem(uint32_t propertyId, uint32_t otherId)
 {
     if (mastercore::isTestEcosystemProperty(propertyId) != mastercore::isTestEcosystemProperty(otherId)) {
@@ -4,10 +4,16 @@
 #include <stdint.h>
 #include <string>
 
+namespace mastercore
+{
+class CMPTallySnapshot;
+}
+
 void RequireBalance(const std::string& address, uint32_t propertyId, int64_t amount);
 void RequirePrimaryToken(uint32_t propertyId);
 void RequirePropertyName(const std::string& name);
 void RequireExistingProperty(uint32_t propertyId);
+void RequireExistingProperty(const mastercore::CMPTallySnapshot& snapshot, uint32_t propertyId);
 void RequireSameEcosystem(uint32_t propertyId, uint32_t otherId);
 void RequireDifferentIds(uint32_t propertyId, uint32_t otherId);
 void RequireCrowdsale(uint32_t propertyId);
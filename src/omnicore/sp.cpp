@@ -28,19 +28,24 @@ using namespace mastercore;
 
 CMPCrowd::CMPCrowd()
   : propertyId(0), nValue(0), property_desired(0), deadline(0),
-    early_bird(0), percentage(0), u_created(0), i_created(0)
+    early_bird(0), percentage(0), u_created(0), i_created(0),
+    amountRaised(0), issuerBonusTokens(0)
 {
 }
 
 CMPCrowd::CMPCrowd(uint32_t pid, int64_t nv, uint32_t cd, int64_t dl, uint8_t eb, uint8_t per, int64_t uct, int64_t ict)
   : propertyId(pid), nValue(nv), property_desired(cd), deadline(dl),
-    early_bird(eb), percentage(per), u_created(uct), i_created(ict)
+    early_bird(eb), percentage(per), u_created(uct), i_created(ict),
+    amountRaised(0), issuerBonusTokens(0)
 {
 }
 
 void CMPCrowd::insertDatabase(const uint256& txHash, const std::vector<int64_t>& txData)
 {
-    txFundraiserData.insert(std::make_pair(txHash, txData));
+    if (txFundraiserData.insert(std::make_pair(txHash, txData)).second) {
+        amountRaised += txData.at(0);
+        issuerBonusTokens += txData.at(3);
+    }
 }
 
 std::string CMPCrowd::toString(const std::string& address) const
@@ -359,6 +364,8 @@ void mastercore::eraseMaxedCrowdsale(const std::string& address, int64_t blockTi
 
         // get txdata
         sp.historicalData = crowdsale.getDatabase();
+        sp.amount_raised = crowdsale.getAmountRaised();
+        sp.issuer_bonus_tokens = crowdsale.getIssuerBonusTokens();
         sp.close_early = true;
         sp.max_tokens = true;
         sp.timeclosed = blockTime;
@@ -402,6 +409,8 @@ unsigned int mastercore::eraseExpiredCrowdsale(const CBlockIndex* pBlockIndex)
 
             // get txdata
             sp.historicalData = crowdsale.getDatabase();
+            sp.amount_raised = crowdsale.getAmountRaised();
+            sp.issuer_bonus_tokens = crowdsale.getIssuerBonusTokens();
             sp.missedTokens = missedTokens;
 
             // update SP with this data
@@ -41,6 +41,10 @@ private:
     //   txid -> amount invested, crowdsale deadline, user issued tokens, issuer issued tokens
     std::map<uint256, std::vector<int64_t> > txFundraiserData;
 
+    // Running totals over txFundraiserData, maintained by insertDatabase()
+    int64_t amountRaised;
+    int64_t issuerBonusTokens;
+
 public:
     CMPCrowd();
     CMPCrowd(uint32_t pid, int64_t nv, uint32_t cd, int64_t dl, uint8_t eb, uint8_t per, int64_t uct, int64_t ict);
@@ -57,7 +61,10 @@ public:
     int64_t getIssuerCreated() const { return i_created; }
 
     void insertDatabase(const uint256& txHash, const std::vector<int64_t>& txData);
-    std::map<uint256, std::vector<int64_t> > getDatabase() const { return txFundraiserData; }
+    const std::map<uint256, std::vector<int64_t> >& getDatabase() const { return txFundraiserData; }
+
+    int64_t getAmountRaised() const { return amountRaised; }
+    int64_t getIssuerBonusTokens() const { return issuerBonusTokens; }
 
     std::string toString(const std::string& address) const;
     void print(const std::string& address, FILE* fp = stdout) const;
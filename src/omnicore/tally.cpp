@@ -4,7 +4,9 @@
 #include <omnicore/omnicore.h>
 
 #include <stdint.h>
+#include <functional>
 #include <map>
+#include <vector>
 
 /**
  * Creates an empty tally.
@@ -44,6 +46,24 @@ uint32_t CMPTally::next()
     return ret;
 }
 
+/**
+ * Returns the identifiers of all tokens with a balance record.
+ *
+ * Unlike init() and next(), this does not modify the tally, and can be used
+ * on shared, immutable tallies.
+ *
+ * @return The property identifiers in ascending order
+ */
+std::vector<uint32_t> CMPTally::getPropertyIds() const
+{
+    std::vector<uint32_t> propertyIds;
+    propertyIds.reserve(mp_token.size());
+    for (TokenMap::const_iterator it = mp_token.begin(); it != mp_token.end(); ++it) {
+        propertyIds.push_back(it->first);
+    }
+    return propertyIds;
+}
+
 /**
  * Checks whether the addition of a + b overflows.
  *
@@ -248,3 +268,55 @@ int64_t CMPTally::print(uint32_t propertyId, bool bDivisible) const
 
     return (balance + selloffer_reserve + accept_reserve);
 }
+
+/**
+ * Returns the number of available tokens.
+ *
+ * Outgoing pending amounts reduce the available balance, while incoming
+ * pending amounts are not available until confirmed.
+ *
+ * @param getBalance  The lookup of the balance for a tally type
+ * @return The available balance
+ */
+int64_t GetAvailableBalance(const TallyBalanceLookup& getBalance)
+{
+    int64_t money = getBalance(BALANCE);
+    int64_t pending = getBalance(PENDING);
+
+    if (0 > pending) {
+        return (money + pending); // show the decrease in available money
+    }
+
+    return money;
+}
+
+/**
+ * Returns the number of tokens reserved by sell offers and accepts.
+ *
+ * @param getBalance  The lookup of the balance for a tally type
+ * @return The reserved balance
+ */
+int64_t GetReservedBalance(const TallyBalanceLookup& getBalance)
+{
+    int64_t nReserved = 0;
+    nReserved += getBalance(ACCEPT_RESERVE);
+    nReserved += getBalance(SELLOFFER_RESERVE);
+
+    return nReserved;
+}
+
+/**
+ * Returns the number of tokens frozen by the issuer.
+ *
+ * @param getBalance  The lookup of the balance for a tally type
+ * @param fFrozen     Whether the entity is frozen for the token
+ * @return The frozen balance
+ */
+int64_t GetFrozenBalance(const TallyBalanceLookup& getBalance, bool fFrozen)
+{
+    if (fFrozen) {
+        return getBalance(BALANCE);
+    }
+
+    return 0;
+}
@@ -2,7 +2,9 @@
 #define BITCOIN_OMNICORE_TALLY_H
 
 #include <stdint.h>
+#include <functional>
 #include <map>
+#include <vector>
 
 //! Balance record types
 enum TallyType {
@@ -39,6 +41,9 @@ public:
     /** Advances the internal iterator. */
     uint32_t next();
 
+    /** Returns the identifiers of all tokens with a balance record. */
+    std::vector<uint32_t> getPropertyIds() const;
+
     /** Updates the number of tokens for the given tally type. */
     bool updateMoney(uint32_t propertyId, int64_t amount, TallyType ttype);
 
@@ -61,5 +66,16 @@ public:
     int64_t print(uint32_t propertyId = 1, bool bDivisible = true) const;
 };
 
+//! Returns the number of tokens of an entity for the given tally type
+typedef std::function<int64_t(TallyType)> TallyBalanceLookup;
+
+/** Returns the number of available tokens, reduced by outgoing pending amounts. */
+int64_t GetAvailableBalance(const TallyBalanceLookup& getBalance);
+
+/** Returns the number of tokens reserved by sell offers and accepts. */
+int64_t GetReservedBalance(const TallyBalanceLookup& getBalance);
+
+/** Returns the number of tokens frozen by the issuer. */
+int64_t GetFrozenBalance(const TallyBalanceLookup& getBalance, bool fFrozen);
 
 #endif // BITCOIN_OMNICORE_TALLY_H
@@ -0,0 +1,115 @@
+/**
+ * @file tallysnapshot.cpp
+ *
+ * Provides immutable snapshots of the balances of all addresses, which are
+ * published after each block, and can be read without holding cs_tally.
+ */
+
+#include <omnicore/tallysnapshot.h>
+
+#include <omnicore/omnicore.h>
+#include <omnicore/tally.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace mastercore
+{
+//! The last published snapshot, only accessed with std::atomic_load and std::atomic_store
+static std::shared_ptr<const CMPTallySnapshot> g_tally_snapshot = std::make_shared<const CMPTallySnapshot>();
+
+/**
+ * Creates an empty snapshot, where all shards point to the same empty shard.
+ */
+CMPTallySnapshot::CMPTallySnapshot() : nBlock(0), nNextSPID{0, 0}
+{
+    std::shared_ptr<const TallyShard> emptyShard = std::make_shared<const TallyShard>();
+    shards.fill(emptyShard);
+    frozenAddresses = std::make_shared<const FrozenSet>();
+}
+
+/**
+ * Returns the shard an address belongs to.
+ */
+size_t CMPTallySnapshot::GetShard(const std::string& address)
+{
+    return std::hash<std::string>()(address) % SHARD_COUNT;
+}
+
+/**
+ * Returns the balance records of an address.
+ *
+ * @param address  The address to lookup
+ * @return The balance records, or nullptr, if the address has none
+ */
+const CMPTally* CMPTallySnapshot::getTally(const std::string& address) const
+{
+    const TallyShard& shard = *shards[GetShard(address)];
+    TallyShard::const_iterator it = shard.find(address);
+    if (it != shard.end()) {
+        return it->second.get();
+    }
+    return nullptr;
+}
+
+int64_t CMPTallySnapshot::getTokenBalance(const std::string& address, uint32_t propertyId, TallyType ttype) const
+{
+    const CMPTally* tally = getTally(address);
+    if (tally == nullptr) {
+        return 0;
+    }
+    return tally->getMoney(propertyId, ttype);
+}
+
+/**
+ * Returns the number of available tokens, as done by GetAvailableTokenBalance().
+ */
+int64_t CMPTallySnapshot::getAvailableTokenBalance(const std::string& address, uint32_t propertyId) const
+{
+    return GetAvailableBalance([&](TallyType ttype) { return getTokenBalance(address, propertyId, ttype); });
+}
+
+int64_t CMPTallySnapshot::getReservedTokenBalance(const std::string& address, uint32_t propertyId) const
+{
+    return GetReservedBalance([&](TallyType ttype) { return getTokenBalance(address, propertyId, ttype); });
+}
+
+int64_t CMPTallySnapshot::getFrozenTokenBalance(const std::string& address, uint32_t propertyId) const
+{
+    return GetFrozenBalance([&](TallyType ttype) { return getTokenBalance(address, propertyId, ttype); },
+            isAddressFrozen(address, propertyId));
+}
+
+bool CMPTallySnapshot::isAddressFrozen(const std::string& address, uint32_t propertyId) const
+{
+    return frozenAddresses->count(std::make_pair(address, propertyId)) > 0;
+}
+
+/**
+ * Checks whether a property identifier was assigned, as done by IsPropertyIdValid().
+ */
+bool CMPTallySnapshot::isPropertyIdValid(uint32_t propertyId) const
+{
+    if (propertyId == 0) return false;
+
+    if (propertyId < TEST_ECO_PROPERTY_1) {
+        return propertyId < nNextSPID[0];
+    }
+    return propertyId < nNextSPID[1];
+}
+
+std::shared_ptr<const CMPTallySnapshot> GetTallySnapshot()
+{
+    return std::atomic_load(&g_tally_snapshot);
+}
+
+void SetTallySnapshot(std::shared_ptr<const CMPTallySnapshot> snapshot)
+{
+    std::atomic_store(&g_tally_snapshot, std::move(snapshot));
+}
+
+} // namespace mastercore
@@ -0,0 +1,77 @@
+#ifndef BITCOIN_OMNICORE_TALLYSNAPSHOT_H
+#define BITCOIN_OMNICORE_TALLYSNAPSHOT_H
+
+#include <omnicore/tally.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace mastercore
+{
+/** Immutable copy of the balances of all addresses, as of a given block.
+ *
+ * Snapshots are published after each block (and after pending balances
+ * change), and can be read without holding cs_tally. Balance records are
+ * spread over shards, so that a new snapshot only copies the shards which
+ * contain changed addresses and shares all other shards with its predecessor.
+ */
+class CMPTallySnapshot
+{
+public:
+    //! Number of shards the addresses are spread over
+    static const size_t SHARD_COUNT = 256;
+
+    typedef std::unordered_map<std::string, std::shared_ptr<const CMPTally> > TallyShard;
+    typedef std::set<std::pair<std::string, uint32_t> > FrozenSet;
+
+    //! Block height of the state
+    int nBlock;
+    //! Next property identifiers of the main and test ecosystem
+    uint32_t nNextSPID[2];
+    //! Balance records of all addresses
+    std::array<std::shared_ptr<const TallyShard>, SHARD_COUNT> shards;
+    //! Frozen addresses and properties
+    std::shared_ptr<const FrozenSet> frozenAddresses;
+
+    /** Creates an empty snapshot. */
+    CMPTallySnapshot();
+
+    /** Returns the shard an address belongs to. */
+    static size_t GetShard(const std::string& address);
+
+    /** Returns the balance records of an address, or nullptr, if there are none. */
+    const CMPTally* getTally(const std::string& address) const;
+
+    /** Returns the number of tokens of an address for the given tally type. */
+    int64_t getTokenBalance(const std::string& address, uint32_t propertyId, TallyType ttype) const;
+
+    /** Returns the number of available tokens, reduced by outgoing pending amounts. */
+    int64_t getAvailableTokenBalance(const std::string& address, uint32_t propertyId) const;
+
+    /** Returns the number of tokens reserved by sell offers and accepts. */
+    int64_t getReservedTokenBalance(const std::string& address, uint32_t propertyId) const;
+
+    /** Returns the number of tokens frozen by the issuer. */
+    int64_t getFrozenTokenBalance(const std::string& address, uint32_t propertyId) const;
+
+    /** Checks whether an address and property are frozen. */
+    bool isAddressFrozen(const std::string& address, uint32_t propertyId) const;
+
+    /** Checks whether a property identifier was assigned. */
+    bool isPropertyIdValid(uint32_t propertyId) const;
+};
+
+/** Returns the last published snapshot of all balances. */
+std::shared_ptr<const CMPTallySnapshot> GetTallySnapshot();
+
+/** Replaces the published snapshot of all balances. */
+void SetTallySnapshot(std::shared_ptr<const CMPTallySnapshot> snapshot);
+}
+
+#endif // BITCOIN_OMNICORE_TALLYSNAPSHOT_H
@@ -1,12 +1,17 @@
+#include <omnicore/dbspinfo.h>
 #include <omnicore/sp.h>
 
+#include <clientversion.h>
+#include <streams.h>
 #include <test/test_bitcoin.h>
+#include <uint256.h>
 
 #include <boost/test/unit_test.hpp>
 
 #include <stdint.h>
 #include <limits>
 #include <utility>
+#include <vector>
 
 BOOST_FIXTURE_TEST_SUITE(omnicore_crowdsale_participation_tests, BasicTestingSetup)
 
@@ -91,4 +96,47 @@ BOOST_AUTO_TEST_CASE(negative_time)
     BOOST_CHECK_EQUAL(95, tokensCreated.second); // issuer
 }
 
+BOOST_AUTO_TEST_CASE(crowdsale_totals)
+{
+    CMPCrowd crowdsale(3, 100, 1, 1407064860000LL, 6, 10, 0, 0);
+
+    std::vector<int64_t> first = {3000000000LL, 1407877014LL, 300, 30};
+    std::vector<int64_t> second = {500000000LL, 1407877015LL, 50, 5};
+
+    crowdsale.insertDatabase(uint256S("01"), first);
+    crowdsale.insertDatabase(uint256S("02"), second);
+    crowdsale.insertDatabase(uint256S("02"), second); // duplicate, ignored
+
+    BOOST_CHECK_EQUAL(2U, crowdsale.getDatabase().size());
+    BOOST_CHECK_EQUAL(3500000000LL, crowdsale.getAmountRaised());
+    BOOST_CHECK_EQUAL(35, crowdsale.getIssuerBonusTokens());
+
+    // totals of closed crowdsales are stored with the entry
+    CMPSPInfo::Entry sp;
+    sp.name = "Crowdsale";
+    sp.historicalData = crowdsale.getDatabase();
+    sp.amount_raised = crowdsale.getAmountRaised();
+    sp.issuer_bonus_tokens = crowdsale.getIssuerBonusTokens();
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << sp;
+    CMPSPInfo::Entry loaded;
+    ss >> loaded;
+
+    BOOST_CHECK_EQUAL(crowdsale.getAmountRaised(), loaded.amount_raised);
+    BOOST_CHECK_EQUAL(crowdsale.getIssuerBonusTokens(), loaded.issuer_bonus_tokens);
+    BOOST_CHECK_EQUAL(2U, loaded.historicalData.size());
+
+    // the totals can be loaded without the participations
+    CDataStream ssWithoutHistory(SER_DISK, CLIENT_VERSION);
+    ssWithoutHistory << sp;
+    CMPSPInfo::Entry properties;
+    properties.SerializationOpWithoutHistory(ssWithoutHistory, CSerActionUnserialize());
+
+    BOOST_CHECK_EQUAL("Crowdsale", properties.name);
+    BOOST_CHECK_EQUAL(crowdsale.getAmountRaised(), properties.amount_raised);
+    BOOST_CHECK_EQUAL(crowdsale.getIssuerBonusTokens(), properties.issuer_bonus_tokens);
+    BOOST_CHECK(properties.historicalData.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+#include <omnicore/consensushash.h>
+#include <omnicore/createpayload.h>
+#include <omnicore/omnicore.h>
+#include <omnicore/rules.h>
+#include <omnicore/tally.h>
+#include <omnicore/tx.h>
+
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mastercore;
+
+namespace {
+/** Sets up a regtest chain, where all transaction types are allowed from genesis on. */
+struct SendToSelfTestingSetup : public TestingSetup
+{
+    SendToSelfTestingSetup() : TestingSetup(CBaseChainParams::REGTEST)
+    {
+        mastercore_init();
+    }
+};
+
+const std::string sender = "mrCDrCybB6J1vRfbwM5hemdJz73FwDBC8r";
+const std::string other = "mzBc4XEFSdzCDcTxAgf6EZXgsZWpztRhef";
+
+/** Executes a transaction with the given payload, as if it was found in the genesis block. */
+int ExecuteTransaction(CMPTransaction& mp_obj, const std::string& from, const std::string& to, std::vector<unsigned char> payload)
+{
+    mp_obj.Set(from, to, 0, uint256S("1"), 0, 1, payload.data(), payload.size(), OMNI_CLASS_C, 0);
+    mp_obj.unlockLogic();
+    return mp_obj.interpretPacket();
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_send_to_self_tests, SendToSelfTestingSetup)
+
+BOOST_AUTO_TEST_CASE(simple_send_to_self)
+{
+    BOOST_CHECK(update_tally_map(sender, OMNI_PROPERTY_MSC, 1000, BALANCE));
+    BOOST_CHECK(update_tally_map(sender, OMNI_PROPERTY_TMSC, 500, BALANCE));
+    uint256 hashBefore = GetConsensusHash();
+
+    CMPTransaction mp_obj;
+    BOOST_CHECK_EQUAL(ExecuteTransaction(mp_obj, sender, sender, CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 1000)), 0);
+    BOOST_CHECK_EQUAL(GetTokenBalance(sender, OMNI_PROPERTY_MSC, BALANCE), 1000);
+    BOOST_CHECK(GetConsensusHash() == hashBefore);
+
+    // The state is the same as after moving the tokens out and back in
+    BOOST_CHECK(update_tally_map(sender, OMNI_PROPERTY_MSC, -1000, BALANCE));
+    BOOST_CHECK(update_tally_map(sender, OMNI_PROPERTY_MSC, 1000, BALANCE));
+    BOOST_CHECK(GetConsensusHash() == hashBefore);
+
+    // More tokens than available are still rejected
+    CMPTransaction mp_obj_invalid;
+    BOOST_CHECK(ExecuteTransaction(mp_obj_invalid, sender, sender, CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 1001)) != 0);
+    BOOST_CHECK(GetConsensusHash() == hashBefore);
+
+    // Sending to another address is unaffected
+    CMPTransaction mp_obj_other;
+    BOOST_CHECK_EQUAL(ExecuteTransaction(mp_obj_other, sender, other, CreatePayload_SimpleSend(OMNI_PROPERTY_MSC, 400)), 0);
+    BOOST_CHECK_EQUAL(GetTokenBalance(sender, OMNI_PROPERTY_MSC, BALANCE), 600);
+    BOOST_CHECK_EQUAL(GetTokenBalance(other, OMNI_PROPERTY_MSC, BALANCE), 400);
+    BOOST_CHECK(GetConsensusHash() != hashBefore);
+}
+
+BOOST_AUTO_TEST_CASE(send_all_to_self)
+{
+    BOOST_CHECK(update_tally_map(sender, OMNI_PROPERTY_MSC, 1000, BALANCE));
+    BOOST_CHECK(update_tally_map(sender, OMNI_PROPERTY_TMSC, 500, BALANCE));
+    uint256 hashBefore = GetConsensusHash();
+
+    CMPTransaction mp_obj;
+    BOOST_CHECK_EQUAL(ExecuteTransaction(mp_obj, sender, sender, CreatePayload_SendAll(OMNI_PROPERTY_MSC)), 0);
+    BOOST_CHECK_EQUAL(mp_obj.getNewAmount(), 1U);
+    BOOST_CHECK_EQUAL(GetTokenBalance(sender, OMNI_PROPERTY_MSC, BALANCE), 1000);
+    BOOST_CHECK_EQUAL(GetTokenBalance(sender, OMNI_PROPERTY_TMSC, BALANCE), 500);
+    BOOST_CHECK(GetConsensusHash() == hashBefore);
+
+    // Sending to another address is unaffected
+    CMPTransaction mp_obj_other;
+    BOOST_CHECK_EQUAL(ExecuteTransaction(mp_obj_other, sender, other, CreatePayload_SendAll(OMNI_PROPERTY_MSC)), 0);
+    BOOST_CHECK_EQUAL(GetTokenBalance(sender, OMNI_PROPERTY_MSC, BALANCE), 0);
+    BOOST_CHECK_EQUAL(GetTokenBalance(other, OMNI_PROPERTY_MSC, BALANCE), 1000);
+    BOOST_CHECK_EQUAL(GetTokenBalance(sender, OMNI_PROPERTY_TMSC, BALANCE), 500);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
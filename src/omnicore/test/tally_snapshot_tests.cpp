@@ -0,0 +1,176 @@
+#include <omnicore/omnicore.h>
+#include <omnicore/pending.h>
+#include <omnicore/tally.h>
+#include <omnicore/tallysnapshot.h>
+
+#include <sync.h>
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mastercore;
+
+namespace {
+/** Starts and ends with an empty tally map and an empty published snapshot. */
+struct TallySnapshotTestingSetup : public BasicTestingSetup
+{
+    TallySnapshotTestingSetup()
+    {
+        ClearTallyMap();
+        SetTallySnapshot(std::make_shared<const CMPTallySnapshot>());
+    }
+    ~TallySnapshotTestingSetup()
+    {
+        ClearTallyMap();
+        ClearFreezeState();
+        SetTallySnapshot(std::make_shared<const CMPTallySnapshot>());
+    }
+};
+
+const std::string addressA = "mrCDrCybB6J1vRfbwM5hemdJz73FwDBC8r";
+const std::string addressB = "mzBc4XEFSdzCDcTxAgf6EZXgsZWpztRhef";
+
+void Publish(int nBlock)
+{
+    LOCK(cs_tally);
+    PublishTallySnapshot(nBlock);
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_tally_snapshot_tests, TallySnapshotTestingSetup)
+
+BOOST_AUTO_TEST_CASE(empty_snapshot)
+{
+    std::shared_ptr<const CMPTallySnapshot> snapshot = GetTallySnapshot();
+    BOOST_CHECK(snapshot->getTally(addressA) == nullptr);
+    BOOST_CHECK_EQUAL(snapshot->getTokenBalance(addressA, 1, BALANCE), 0);
+    BOOST_CHECK(!snapshot->isPropertyIdValid(1));
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_is_immutable)
+{
+    BOOST_CHECK(update_tally_map(addressA, 3, 1000, BALANCE));
+    BOOST_CHECK(update_tally_map(addressA, 5, 70, SELLOFFER_RESERVE));
+    BOOST_CHECK(update_tally_map(addressA, 5, 30, ACCEPT_RESERVE));
+
+    // Unpublished changes are not visible
+    BOOST_CHECK_EQUAL(GetTallySnapshot()->getTokenBalance(addressA, 3, BALANCE), 0);
+
+    Publish(10);
+    std::shared_ptr<const CMPTallySnapshot> first = GetTallySnapshot();
+    BOOST_CHECK_EQUAL(first->nBlock, 10);
+    BOOST_CHECK_EQUAL(first->getAvailableTokenBalance(addressA, 3), 1000);
+    BOOST_CHECK_EQUAL(first->getReservedTokenBalance(addressA, 5), 100);
+    BOOST_CHECK(first->getTally(addressA)->getPropertyIds() == std::vector<uint32_t>({3, 5}));
+
+    BOOST_CHECK(update_tally_map(addressA, 3, -400, BALANCE));
+    BOOST_CHECK(update_tally_map(addressB, 3, 400, BALANCE));
+    BOOST_CHECK(update_tally_map(addressA, 3, -100, PENDING));
+    Publish(11);
+    std::shared_ptr<const CMPTallySnapshot> second = GetTallySnapshot();
+    BOOST_CHECK_EQUAL(second->nBlock, 11);
+    BOOST_CHECK_EQUAL(second->getTokenBalance(addressA, 3, BALANCE), 600);
+    BOOST_CHECK_EQUAL(second->getAvailableTokenBalance(addressA, 3), 500);
+    BOOST_CHECK_EQUAL(second->getTokenBalance(addressB, 3, BALANCE), 400);
+
+    // The previous snapshot still holds the old state
+    BOOST_CHECK_EQUAL(first->getTokenBalance(addressA, 3, BALANCE), 1000);
+    BOOST_CHECK(first->getTally(addressB) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(unchanged_shards_are_shared)
+{
+    BOOST_CHECK(update_tally_map(addressA, 3, 1000, BALANCE));
+    BOOST_CHECK(update_tally_map(addressB, 3, 1000, BALANCE));
+    Publish(1);
+    std::shared_ptr<const CMPTallySnapshot> first = GetTallySnapshot();
+
+    BOOST_CHECK(update_tally_map(addressA, 3, 1, BALANCE));
+    Publish(2);
+    std::shared_ptr<const CMPTallySnapshot> second = GetTallySnapshot();
+
+    const size_t shardA = CMPTallySnapshot::GetShard(addressA);
+    const size_t shardB = CMPTallySnapshot::GetShard(addressB);
+    BOOST_CHECK(first->shards[shardA] != second->shards[shardA]);
+    if (shardA != shardB) {
+        BOOST_CHECK(first->shards[shardB] == second->shards[shardB]);
+    }
+    BOOST_CHECK(first->getTally(addressB) == second->getTally(addressB));
+}
+
+BOOST_AUTO_TEST_CASE(cleared_tally_map)
+{
+    BOOST_CHECK(update_tally_map(addressA, 3, 1000, BALANCE));
+    Publish(1);
+    BOOST_CHECK(GetTallySnapshot()->getTally(addressA) != nullptr);
+
+    ClearTallyMap();
+    BOOST_CHECK(update_tally_map(addressB, 3, 1000, BALANCE));
+    Publish(2);
+    BOOST_CHECK(GetTallySnapshot()->getTally(addressA) == nullptr);
+    BOOST_CHECK_EQUAL(GetTallySnapshot()->getTokenBalance(addressB, 3, BALANCE), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(frozen_balances)
+{
+    BOOST_CHECK(update_tally_map(addressA, 3, 1000, BALANCE));
+    freezeAddress(addressA, 3);
+    Publish(1);
+    unfreezeAddress(addressA, 3);
+
+    BOOST_CHECK(GetTallySnapshot()->isAddressFrozen(addressA, 3));
+    BOOST_CHECK_EQUAL(GetTallySnapshot()->getFrozenTokenBalance(addressA, 3), 1000);
+
+    Publish(2);
+    BOOST_CHECK(!GetTallySnapshot()->isAddressFrozen(addressA, 3));
+    BOOST_CHECK_EQUAL(GetTallySnapshot()->getFrozenTokenBalance(addressA, 3), 0);
+}
+
+BOOST_AUTO_TEST_CASE(pending_during_block)
+{
+    BOOST_CHECK(update_tally_map(addressA, 3, 1000, BALANCE));
+    Publish(1);
+
+    // A block is processed partially: addressA sent 400 tokens to addressB,
+    // but the tokens were not yet credited to addressB
+    BOOST_CHECK(update_tally_map(addressA, 3, -400, BALANCE));
+
+    // A pending transaction is added in the meantime
+    const uint256 txid = uint256S("01");
+    PendingAdd(txid, addressA, MSC_TYPE_SIMPLE_SEND, 3, 100);
+
+    // Only the pending amount is published, not the partially processed block
+    std::shared_ptr<const CMPTallySnapshot> pending = GetTallySnapshot();
+    BOOST_CHECK_EQUAL(pending->nBlock, 1);
+    BOOST_CHECK_EQUAL(pending->getTokenBalance(addressA, 3, BALANCE), 1000);
+    BOOST_CHECK_EQUAL(pending->getTokenBalance(addressA, 3, PENDING), -100);
+    BOOST_CHECK_EQUAL(pending->getAvailableTokenBalance(addressA, 3), 900);
+    BOOST_CHECK(pending->getTally(addressB) == nullptr);
+
+    // The block and the pending amount are published at the end of the block
+    BOOST_CHECK(update_tally_map(addressB, 3, 400, BALANCE));
+    Publish(2);
+    std::shared_ptr<const CMPTallySnapshot> block = GetTallySnapshot();
+    BOOST_CHECK_EQUAL(block->nBlock, 2);
+    BOOST_CHECK_EQUAL(block->getTokenBalance(addressA, 3, BALANCE), 600);
+    BOOST_CHECK_EQUAL(block->getAvailableTokenBalance(addressA, 3), 500);
+    BOOST_CHECK_EQUAL(block->getTokenBalance(addressB, 3, BALANCE), 400);
+
+    // Confirming the pending transaction is published with its block
+    {
+        LOCK(cs_tally);
+        PendingDelete(txid);
+    }
+    BOOST_CHECK_EQUAL(GetTallySnapshot()->getTokenBalance(addressA, 3, PENDING), -100);
+    Publish(3);
+    BOOST_CHECK_EQUAL(GetTallySnapshot()->getTokenBalance(addressA, 3, PENDING), 0);
+    BOOST_CHECK_EQUAL(GetTallySnapshot()->getAvailableTokenBalance(addressA, 3), 600);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
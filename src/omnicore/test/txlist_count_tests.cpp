@@ -0,0 +1,65 @@
+#include <omnicore/dbtxlist.h>
+#include <omnicore/omnicore.h>
+
+#include <test/test_bitcoin.h>
+#include <uint256.h>
+
+#include <stdint.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mastercore;
+
+BOOST_FIXTURE_TEST_SUITE(omnicore_txlist_count_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(txlist_counts)
+{
+    LOCK(cs_tally);
+    CMPTxList* txlist = new CMPTxList(GetDataDir() / "MP_txlist", true);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountTotal(), 0);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(100), 0);
+
+    txlist->recordTX(uint256S("01"), true, 100, 0, 1000);
+    txlist->recordTX(uint256S("02"), false, 100, 0, 1000);
+    txlist->recordTX(uint256S("03"), true, 101, 0, 1000);
+    txlist->recordSendAllSubRecord(uint256S("03"), 1, 3, 1000);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountTotal(), 3);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(100), 2);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(101), 1);
+
+    // Several payments of one transaction share one master record
+    txlist->recordPaymentTX(uint256S("04"), true, 102, 1, 1, 500, "buyer", "seller");
+    txlist->recordPaymentTX(uint256S("04"), true, 102, 2, 1, 500, "buyer", "seller");
+    BOOST_CHECK_EQUAL(txlist->getNumberOfSubRecords(uint256S("04")), 2);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountTotal(), 4);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(102), 1);
+
+    // An overwritten record is only counted for its new block
+    txlist->recordTX(uint256S("02"), true, 102, 0, 1000);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountTotal(), 4);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(100), 1);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(102), 2);
+
+    // Rolling back blocks removes their transactions from the counters
+    BOOST_CHECK(txlist->isMPinBlockRange(101, 102, false));
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountTotal(), 4);
+    BOOST_CHECK(txlist->isMPinBlockRange(101, 102, true));
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountTotal(), 1);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(100), 1);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(101), 0);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(102), 0);
+
+    // The counters are persisted
+    delete txlist;
+    txlist = new CMPTxList(GetDataDir() / "MP_txlist", false);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountTotal(), 1);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(100), 1);
+
+    // All counters are dropped together with the records
+    txlist->Clear();
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountTotal(), 0);
+    BOOST_CHECK_EQUAL(txlist->getMPTransactionCountBlock(100), 0);
+    delete txlist;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
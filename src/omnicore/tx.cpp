@@ -1034,9 +1034,12 @@ int CMPTransaction::logicMath_SimpleSend(uint256& blockHash)
 
     // ------------------------------------------
 
-    // Move the tokens
-    assert(update_tally_map(sender, property, -nValue, BALANCE));
-    assert(update_tally_map(receiver, property, nValue, BALANCE));
+    // Move the tokens, unless they are sent to the sender itself, in which
+    // case the balance remains the same
+    if (sender != receiver) {
+        assert(update_tally_map(sender, property, -nValue, BALANCE));
+        assert(update_tally_map(receiver, property, nValue, BALANCE));
+    }
 
     // Is there an active crowdsale running from this recipient?
     logicHelper_CrowdsaleParticipation(blockHash);
@@ -1156,6 +1159,9 @@ int CMPTransaction::logicMath_SendAll()
         return (PKT_ERROR_SEND_ALL -54);
     }
 
+    // Tokens sent to the sender itself are recorded, but no balance changes
+    const bool fSendToSelf = (sender == receiver);
+
     uint32_t propertyId = ptally->init();
     int numberOfPropertiesSent = 0;
 
@@ -1177,8 +1183,10 @@ int CMPTransaction::logicMath_SendAll()
         int64_t moneyAvailable = ptally->getMoney(propertyId, BALANCE);
         if (moneyAvailable > 0) {
             ++numberOfPropertiesSent;
-            assert(update_tally_map(sender, propertyId, -moneyAvailable, BALANCE));
-            assert(update_tally_map(receiver, propertyId, moneyAvailable, BALANCE));
+            if (!fSendToSelf) {
+                assert(update_tally_map(sender, propertyId, -moneyAvailable, BALANCE));
+                assert(update_tally_map(receiver, propertyId, moneyAvailable, BALANCE));
+            }
             pDbTransactionList->recordSendAllSubRecord(txid, numberOfPropertiesSent, propertyId, moneyAvailable);
         }
     }
@@ -1616,6 +1624,8 @@ int CMPTransaction::logicMath_CloseCrowdsale(CBlockIndex* pindex)
     int64_t missedTokens = GetMissedIssuerBonus(sp, crowd);
 
     sp.historicalData = crowd.getDatabase();
+    sp.amount_raised = crowd.getAmountRaised();
+    sp.issuer_bonus_tokens = crowd.getIssuerBonusTokens();
     sp.update_block = blockHash;
     sp.close_early = true;
     sp.timeclosed = blockTime;
@@ -7,6 +7,7 @@
 
 #include <amount.h>
 #include <base58.h>
+#include <blockcache.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -16,6 +17,7 @@
 #include <keystore.h>
 #include <core_io.h>
 #include <hash.h>
+#include <index/blockstatsindex.h>
 #include <index/txindex.h>
 #include <key_io.h>
 #include <policy/feerate.h>
@@ -25,10 +27,12 @@
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <script/descriptor.h>
+#include <shutdown.h>
 #include <streams.h>
 #include <sync.h>
 #include <txdb.h>
 #include <txmempool.h>
+#include <undo.h>
 #include <util/strencodings.h>
 #include <util/system.h>
 #include <validation.h>
@@ -43,8 +47,12 @@
 
 #include <boost/thread/thread.hpp> // boost::thread::interrupt
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <unordered_set>
 #include <condition_variable>
 
 struct CUpdatedBlock
@@ -407,35 +415,91 @@ static std::string EntryDescriptionString()
            "    \"bip125-replaceable\" : true|false,  (boolean) Whether this transaction could be replaced due to BIP125 (replace-by-fee)\n";
 }
 
-static void entryToJSON(UniValue &info, const CTxMemPoolEntry &e) EXCLUSIVE_LOCKS_REQUIRED(::mempool.cs)
+/** Fields of a mempool entry, copied while holding mempool.cs, so that the JSON can be built without it. */
+struct MempoolEntryInfo
+{
+    uint256 txid;
+    uint256 wtxid;
+    CAmount fee;
+    CAmount modifiedFee;
+    size_t size;
+    int64_t time;
+    unsigned int height;
+    uint64_t descendantCount;
+    uint64_t descendantSize;
+    CAmount descendantFees;
+    uint64_t ancestorCount;
+    uint64_t ancestorSize;
+    CAmount ancestorFees;
+    std::vector<uint256> depends;
+    std::vector<uint256> spentBy;
+    bool fReplaceable;
+};
+
+static MempoolEntryInfo GetEntryInfo(const CTxMemPoolEntry &e) EXCLUSIVE_LOCKS_REQUIRED(::mempool.cs)
 {
     AssertLockHeld(mempool.cs);
 
+    MempoolEntryInfo entry;
+    const CTransaction& tx = e.GetTx();
+    entry.txid = tx.GetHash();
+    entry.wtxid = mempool.vTxHashes[e.vTxHashesIdx].first;
+    entry.fee = e.GetFee();
+    entry.modifiedFee = e.GetModifiedFee();
+    entry.size = e.GetTxSize();
+    entry.time = e.GetTime();
+    entry.height = e.GetHeight();
+    entry.descendantCount = e.GetCountWithDescendants();
+    entry.descendantSize = e.GetSizeWithDescendants();
+    entry.descendantFees = e.GetModFeesWithDescendants();
+    entry.ancestorCount = e.GetCountWithAncestors();
+    entry.ancestorSize = e.GetSizeWithAncestors();
+    entry.ancestorFees = e.GetModFeesWithAncestors();
+
+    // The in-mempool parents are exactly the unconfirmed transactions spent by the inputs
+    const CTxMemPool::txiter it = mempool.mapTx.find(entry.txid);
+    for (CTxMemPool::txiter parentiter : mempool.GetMemPoolParents(it)) {
+        entry.depends.push_back(parentiter->GetTx().GetHash());
+    }
+    for (CTxMemPool::txiter childiter : mempool.GetMemPoolChildren(it)) {
+        entry.spentBy.push_back(childiter->GetTx().GetHash());
+    }
+
+    // Add opt-in RBF status
+    RBFTransactionState rbfState = IsRBFOptIn(tx, mempool);
+    if (rbfState == RBFTransactionState::UNKNOWN) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Transaction is not in mempool");
+    }
+    entry.fReplaceable = (rbfState == RBFTransactionState::REPLACEABLE_BIP125);
+
+    return entry;
+}
+
+static void entryToJSON(UniValue &info, const MempoolEntryInfo &e)
+{
     UniValue fees(UniValue::VOBJ);
-    fees.pushKV("base", ValueFromAmount(e.GetFee()));
-    fees.pushKV("modified", ValueFromAmount(e.GetModifiedFee()));
-    fees.pushKV("ancestor", ValueFromAmount(e.GetModFeesWithAncestors()));
-    fees.pushKV("descendant", ValueFromAmount(e.GetModFeesWithDescendants()));
+    fees.pushKV("base", ValueFromAmount(e.fee));
+    fees.pushKV("modified", ValueFromAmount(e.modifiedFee));
+    fees.pushKV("ancestor", ValueFromAmount(e.ancestorFees));
+    fees.pushKV("descendant", ValueFromAmount(e.descendantFees));
     info.pushKV("fees", fees);
 
-    info.pushKV("size", (int)e.GetTxSize());
-    info.pushKV("fee", ValueFromAmount(e.GetFee()));
-    info.pushKV("modifiedfee", ValueFromAmount(e.GetModifiedFee()));
-    info.pushKV("time", e.GetTime());
-    info.pushKV("height", (int)e.GetHeight());
-    info.pushKV("descendantcount", e.GetCountWithDescendants());
-    info.pushKV("descendantsize", e.GetSizeWithDescendants());
-    info.pushKV("descendantfees", e.GetModFeesWithDescendants());
-    info.pushKV("ancestorcount", e.GetCountWithAncestors());
-    info.pushKV("ancestorsize", e.GetSizeWithAncestors());
-    info.pushKV("ancestorfees", e.GetModFeesWithAncestors());
-    info.pushKV("wtxid", mempool.vTxHashes[e.vTxHashesIdx].first.ToString());
-    const CTransaction& tx = e.GetTx();
+    info.pushKV("size", (int)e.size);
+    info.pushKV("fee", ValueFromAmount(e.fee));
+    info.pushKV("modifiedfee", ValueFromAmount(e.modifiedFee));
+    info.pushKV("time", e.time);
+    info.pushKV("height", (int)e.height);
+    info.pushKV("descendantcount", e.descendantCount);
+    info.pushKV("descendantsize", e.descendantSize);
+    info.pushKV("descendantfees", e.descendantFees);
+    info.pushKV("ancestorcount", e.ancestorCount);
+    info.pushKV("ancestorsize", e.ancestorSize);
+    info.pushKV("ancestorfees", e.ancestorFees);
+    info.pushKV("wtxid", e.wtxid.ToString());
+
     std::set<std::string> setDepends;
-    for (const CTxIn& txin : tx.vin)
-    {
-        if (mempool.exists(txin.prevout.hash))
-            setDepends.insert(txin.prevout.hash.ToString());
+    for (const uint256& hash : e.depends) {
+        setDepends.insert(hash.ToString());
     }
 
     UniValue depends(UniValue::VARR);
@@ -447,45 +511,55 @@ static void entryToJSON(UniValue &info, const CTxMemPoolEntry &e) EXCLUSIVE_LOCK
     info.pushKV("depends", depends);
 
     UniValue spent(UniValue::VARR);
-    const CTxMemPool::txiter &it = mempool.mapTx.find(tx.GetHash());
-    const CTxMemPool::setEntries &setChildren = mempool.GetMemPoolChildren(it);
-    for (CTxMemPool::txiter childiter : setChildren) {
-        spent.push_back(childiter->GetTx().GetHash().ToString());
+    for (const uint256& hash : e.spentBy) {
+        spent.push_back(hash.ToString());
     }
 
     info.pushKV("spentby", spent);
 
-    // Add opt-in RBF status
-    bool rbfStatus = false;
-    RBFTransactionState rbfState = IsRBFOptIn(tx, mempool);
-    if (rbfState == RBFTransactionState::UNKNOWN) {
-        throw JSONRPCError(RPC_MISC_ERROR, "Transaction is not in mempool");
-    } else if (rbfState == RBFTransactionState::REPLACEABLE_BIP125) {
-        rbfStatus = true;
-    }
+    info.pushKV("bip125-replaceable", e.fReplaceable);
+}
 
-    info.pushKV("bip125-replaceable", rbfStatus);
+static void entryToJSON(UniValue &info, const CTxMemPoolEntry &e) EXCLUSIVE_LOCKS_REQUIRED(::mempool.cs)
+{
+    entryToJSON(info, GetEntryInfo(e));
 }
 
-UniValue mempoolToJSON(bool fVerbose)
+/** Orders transaction ids like their hex strings, i.e. starting with the most significant byte. */
+static bool CompareTxidDisplayOrder(const uint256& a, const uint256& b)
 {
-    if (fVerbose)
-    {
-        LOCK(mempool.cs);
-        UniValue o(UniValue::VOBJ);
-        for (const CTxMemPoolEntry& e : mempool.mapTx)
+    return std::lexicographical_compare(
+        std::reverse_iterator<const unsigned char*>(a.end()), std::reverse_iterator<const unsigned char*>(a.begin()),
+        std::reverse_iterator<const unsigned char*>(b.end()), std::reverse_iterator<const unsigned char*>(b.begin()));
+}
+
+UniValue mempoolToJSON(bool fVerbose, const uint256& start, size_t count)
+{
+    const bool fPaginate = !start.IsNull() || count > 0;
+
+    // For pagination, the transactions are ordered by txid, and the page
+    // starts after the given txid, so that the cursor stays valid, even if
+    // the transaction it refers to left the mempool in the meantime
+    std::vector<uint256> vtxid;
+    if (fPaginate) {
         {
-            const uint256& hash = e.GetTx().GetHash();
-            UniValue info(UniValue::VOBJ);
-            entryToJSON(info, e);
-            o.pushKV(hash.ToString(), info);
+            LOCK(mempool.cs);
+            vtxid.reserve(mempool.mapTx.size());
+            for (const CTxMemPoolEntry& e : mempool.mapTx) {
+                vtxid.push_back(e.GetTx().GetHash());
+            }
         }
-        return o;
+        std::sort(vtxid.begin(), vtxid.end(), CompareTxidDisplayOrder);
+        vtxid.erase(vtxid.begin(), std::upper_bound(vtxid.begin(), vtxid.end(), start, CompareTxidDisplayOrder));
     }
-    else
+
+    if (!fVerbose)
     {
-        std::vector<uint256> vtxid;
-        mempool.queryHashes(vtxid);
+        if (!fPaginate) {
+            mempool.queryHashes(vtxid);
+        } else if (count > 0 && count < vtxid.size()) {
+            vtxid.resize(count);
+        }
 
         UniValue a(UniValue::VARR);
         for (const uint256& hash : vtxid)
@@ -493,17 +567,56 @@ UniValue mempoolToJSON(bool fVerbose)
 
         return a;
     }
+
+    // Only the entry fields are copied while holding mempool.cs, the JSON
+    // is built after releasing it
+    std::vector<MempoolEntryInfo> entries;
+    {
+        LOCK(mempool.cs);
+        if (fPaginate) {
+            const size_t nMax = count > 0 ? count : vtxid.size();
+            entries.reserve(std::min(nMax, vtxid.size()));
+            for (const uint256& hash : vtxid) {
+                if (entries.size() >= nMax) break;
+                // Skip transactions, which were removed since the txids were collected
+                CTxMemPool::txiter it = mempool.mapTx.find(hash);
+                if (it != mempool.mapTx.end()) {
+                    entries.push_back(GetEntryInfo(*it));
+                }
+            }
+        } else {
+            entries.reserve(mempool.mapTx.size());
+            for (const CTxMemPoolEntry& e : mempool.mapTx) {
+                entries.push_back(GetEntryInfo(e));
+            }
+        }
+    }
+
+    UniValue o(UniValue::VOBJ);
+    for (const MempoolEntryInfo& entry : entries)
+    {
+        UniValue info(UniValue::VOBJ);
+        entryToJSON(info, entry);
+        // Transaction ids are unique, so the linear lookup of pushKV can be skipped
+        o.__pushKV(entry.txid.ToString(), info);
+    }
+    return o;
 }
 
 static UniValue getrawmempool(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() > 1)
+    if (request.fHelp || request.params.size() > 3)
         throw std::runtime_error(
             RPCHelpMan{"getrawmempool",
                 "\nReturns all transaction ids in memory pool as a json array of string transaction ids.\n"
-                "\nHint: use getmempoolentry to fetch a specific transaction from the mempool.\n",
+                "\nHint: use getmempoolentry to fetch a specific transaction from the mempool.\n"
+                "\nIf \"start\" or \"count\" are given, the transactions are ordered by transaction id, and at most \"count\"\n"
+                "transactions with an id greater than \"start\" are returned. To fetch the next page, pass the last\n"
+                "returned transaction id as \"start\". A page with less than \"count\" transactions is the last one.\n",
                 {
                     {"verbose", RPCArg::Type::BOOL, /* default */ "false", "True for a json object, false for array of transaction ids"},
+                    {"start", RPCArg::Type::STR_HEX, /* default */ "", "Only return transactions with an id greater than this one"},
+                    {"count", RPCArg::Type::NUM, /* default */ "0", "The maximum number of transactions to return, 0 for no limit"},
                 },
                 RPCResult{"for verbose = false",
             "[                     (json array of string)\n"
@@ -519,6 +632,7 @@ static UniValue getrawmempool(const JSONRPCRequest& request)
                 },
                 RPCExamples{
                     HelpExampleCli("getrawmempool", "true")
+            + HelpExampleCli("getrawmempool", "true \"\" 1000")
             + HelpExampleRpc("getrawmempool", "true")
                 },
             }.ToString());
@@ -527,7 +641,18 @@ static UniValue getrawmempool(const JSONRPCRequest& request)
     if (!request.params[0].isNull())
         fVerbose = request.params[0].get_bool();
 
-    return mempoolToJSON(fVerbose);
+    uint256 start;
+    if (!request.params[1].isNull() && !request.params[1].get_str().empty())
+        start = ParseHashV(request.params[1], "start");
+
+    int64_t count = 0;
+    if (!request.params[2].isNull()) {
+        count = request.params[2].get_int64();
+        if (count < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+    }
+
+    return mempoolToJSON(fVerbose, start, (size_t)count);
 }
 
 static UniValue clearmempool(const JSONRPCRequest& request)
@@ -854,6 +979,24 @@ static CBlock GetBlockChecked(const CBlockIndex* pblockindex)
     return block;
 }
 
+static CBlockUndo GetUndoChecked(const CBlockIndex* pblockindex)
+{
+    CBlockUndo blockUndo;
+    // The genesis block has no undo data
+    if (pblockindex->pprev == nullptr) {
+        return blockUndo;
+    }
+    if (IsBlockPruned(pblockindex)) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Undo data not available (pruned data)");
+    }
+
+    if (!UndoReadFromDisk(blockUndo, pblockindex)) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Can't read undo data from disk");
+    }
+
+    return blockUndo;
+}
+
 static UniValue getblock(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
@@ -1044,6 +1187,12 @@ struct CCoinsStats
     CCoinsStats() : nHeight(0), nTransactions(0), nTransactionOutputs(0), nBogoSize(0), nDiskSize(0), nTotalAmount(0) {}
 };
 
+enum class CoinStatsHashType {
+    HASH_SERIALIZED,
+    MUHASH,
+    NONE,
+};
+
 static void ApplyStats(CCoinsStats &stats, CHashWriter& ss, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
 {
     assert(!outputs.empty());
@@ -1101,6 +1250,68 @@ static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
     return true;
 }
 
+//! Calculate the order-independent statistics of the coins database from scratch
+static bool ScanCoinsSetStats(CCoinsView *view, uint256& hashBlock, CCoinsSetStats &stats)
+{
+    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
+    assert(pcursor);
+
+    hashBlock = pcursor->GetBestBlock();
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        COutPoint key;
+        Coin coin;
+        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+            stats.AddCoin(key, coin);
+        } else {
+            return error("%s: unable to read value", __func__);
+        }
+        pcursor->Next();
+    }
+    return true;
+}
+
+/**
+ * Retrieve the maintained statistics of the unspent transaction output set at
+ * the tip. If they are not yet known, e.g. after upgrading an existing chain
+ * state, they are calculated once from the coins database and stored.
+ */
+static bool GetMaintainedUTXOStats(CCoinsStats &stats, CoinStatsHashType hash_type)
+{
+    CCoinsSetStats setStats;
+    bool fKnown;
+    {
+        LOCK(cs_main);
+        fKnown = pcoinsTip->GetStats(setStats);
+        if (fKnown) {
+            stats.hashBlock = pcoinsTip->GetBestBlock();
+            stats.nHeight = LookupBlockIndex(stats.hashBlock)->nHeight;
+        }
+    }
+
+    if (!fKnown) {
+        FlushStateToDisk();
+        if (!ScanCoinsSetStats(pcoinsdbview.get(), stats.hashBlock, setStats)) {
+            return false;
+        }
+        LOCK(cs_main);
+        stats.nHeight = LookupBlockIndex(stats.hashBlock)->nHeight;
+        // Only stored, if the database wasn't modified during the scan
+        if (pcoinsdbview->WriteStats(stats.hashBlock, setStats)) {
+            LogPrintf("%s: stored statistics of the coins database at height %d\n", __func__, stats.nHeight);
+        }
+    }
+
+    stats.nTransactionOutputs = setStats.nTransactionOutputs;
+    stats.nBogoSize = setStats.nBogoSize;
+    stats.nTotalAmount = setStats.nTotalAmount;
+    if (hash_type == CoinStatsHashType::MUHASH) {
+        setStats.muhash.Finalize(stats.hashSerialized);
+    }
+    stats.nDiskSize = pcoinsdbview->EstimateSize();
+    return true;
+}
+
 static UniValue pruneblockchain(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -1161,49 +1372,94 @@ static UniValue pruneblockchain(const JSONRPCRequest& request)
 
 static UniValue gettxoutsetinfo(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 0)
+    if (request.fHelp || request.params.size() > 1)
         throw std::runtime_error(
             RPCHelpMan{"gettxoutsetinfo",
                 "\nReturns statistics about the unspent transaction output set.\n"
-                "Note this call may take some time.\n",
-                {},
+                "Note this call may take some time, when using hash_serialized_2.\n",
+                {
+                    {"hash_type", RPCArg::Type::STR, /* default */ "hash_serialized_2", "Which UTXO set hash should be calculated. Options: 'hash_serialized_2' (the legacy algorithm, which scans the whole set), 'muhash', 'none'.\n"
+            "                  'muhash' and 'none' are served from statistics, which are maintained as blocks are connected and disconnected."},
+                },
                 RPCResult{
             "{\n"
             "  \"height\":n,     (numeric) The current block height (index)\n"
             "  \"bestblock\": \"hex\",   (string) The hash of the block at the tip of the chain\n"
-            "  \"transactions\": n,      (numeric) The number of transactions with unspent outputs\n"
+            "  \"transactions\": n,      (numeric) The number of transactions with unspent outputs (only with hash_serialized_2)\n"
             "  \"txouts\": n,            (numeric) The number of unspent transaction outputs\n"
             "  \"bogosize\": n,          (numeric) A meaningless metric for UTXO set size\n"
-            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash\n"
+            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash (only present if 'hash_serialized_2' hash_type is chosen)\n"
+            "  \"muhash\": \"hash\",       (string) The serialized hash (only present if 'muhash' hash_type is chosen)\n"
             "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
             "}\n"
                 },
                 RPCExamples{
                     HelpExampleCli("gettxoutsetinfo", "")
+            + HelpExampleCli("gettxoutsetinfo", "\"muhash\"")
             + HelpExampleRpc("gettxoutsetinfo", "")
                 },
             }.ToString());
 
+    CoinStatsHashType hash_type = CoinStatsHashType::HASH_SERIALIZED;
+    if (!request.params[0].isNull()) {
+        const std::string& hash_type_input = request.params[0].get_str();
+        if (hash_type_input == "hash_serialized_2") {
+            hash_type = CoinStatsHashType::HASH_SERIALIZED;
+        } else if (hash_type_input == "muhash") {
+            hash_type = CoinStatsHashType::MUHASH;
+        } else if (hash_type_input == "none") {
+            hash_type = CoinStatsHashType::NONE;
+        } else {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("%s is not a valid hash_type", hash_type_input));
+        }
+    }
+
     UniValue ret(UniValue::VOBJ);
 
     CCoinsStats stats;
-    FlushStateToDisk();
-    if (GetUTXOStats(pcoinsdbview.get(), stats)) {
-        ret.pushKV("height", (int64_t)stats.nHeight);
-        ret.pushKV("bestblock", stats.hashBlock.GetHex());
+    if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
+        FlushStateToDisk();
+        if (!GetUTXOStats(pcoinsdbview.get(), stats)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
+        }
+    } else if (!GetMaintainedUTXOStats(stats, hash_type)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
+    }
+
+    ret.pushKV("height", (int64_t)stats.nHeight);
+    ret.pushKV("bestblock", stats.hashBlock.GetHex());
+    if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
         ret.pushKV("transactions", (int64_t)stats.nTransactions);
-        ret.pushKV("txouts", (int64_t)stats.nTransactionOutputs);
-        ret.pushKV("bogosize", (int64_t)stats.nBogoSize);
+    }
+    ret.pushKV("txouts", (int64_t)stats.nTransactionOutputs);
+    ret.pushKV("bogosize", (int64_t)stats.nBogoSize);
+    if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
         ret.pushKV("hash_serialized_2", stats.hashSerialized.GetHex());
-        ret.pushKV("disk_size", stats.nDiskSize);
-        ret.pushKV("total_amount", ValueFromAmount(stats.nTotalAmount));
-    } else {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
+    } else if (hash_type == CoinStatsHashType::MUHASH) {
+        ret.pushKV("muhash", stats.hashSerialized.GetHex());
     }
+    ret.pushKV("disk_size", stats.nDiskSize);
+    ret.pushKV("total_amount", ValueFromAmount(stats.nTotalAmount));
     return ret;
 }
 
+/** Describe an unspent output, as seen from the given chain tip. */
+static void CoinToJSON(UniValue& ret, const Coin& coin, const uint256& best_block, int best_height)
+{
+    ret.pushKV("bestblock", best_block.GetHex());
+    if (coin.nHeight == MEMPOOL_HEIGHT) {
+        ret.pushKV("confirmations", 0);
+    } else {
+        ret.pushKV("confirmations", (int64_t)(best_height - coin.nHeight + 1));
+    }
+    ret.pushKV("value", ValueFromAmount(coin.out.nValue));
+    UniValue o(UniValue::VOBJ);
+    ScriptPubKeyToUniv(coin.out.scriptPubKey, o, true);
+    ret.pushKV("scriptPubKey", o);
+    ret.pushKV("coinbase", (bool)coin.fCoinBase);
+}
+
 UniValue gettxout(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() < 2 || request.params.size() > 3)
@@ -1268,18 +1524,107 @@ UniValue gettxout(const JSONRPCRequest& request)
     }
 
     const CBlockIndex* pindex = LookupBlockIndex(pcoinsTip->GetBestBlock());
-    ret.pushKV("bestblock", pindex->GetBlockHash().GetHex());
-    if (coin.nHeight == MEMPOOL_HEIGHT) {
-        ret.pushKV("confirmations", 0);
-    } else {
-        ret.pushKV("confirmations", (int64_t)(pindex->nHeight - coin.nHeight + 1));
+    CoinToJSON(ret, coin, pindex->GetBlockHash(), pindex->nHeight);
+
+    return ret;
+}
+
+static UniValue gettxouts(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            RPCHelpMan{"gettxouts",
+                "\nReturns details about several unspent transaction outputs at once.\n"
+                "\nAll outputs are looked up under one lock, in the key order of the chainstate database.\n",
+                {
+                    {"outpoints", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array of outpoints",
+                        {
+                            {"", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "",
+                                {
+                                    {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The transaction id"},
+                                    {"vout", RPCArg::Type::NUM, RPCArg::Optional::NO, "The output number"},
+                                },
+                            },
+                        },
+                    },
+                    {"include_mempool", RPCArg::Type::BOOL, /* default */ "true", "Whether to include the mempool. Note that an unspent output that is spent in the mempool won't appear."},
+                },
+                RPCResult{
+            "[                            (array) In the same order as outpoints\n"
+            "  {                          (json object) Like gettxout, or null if the output is not unspent\n"
+            "    \"txid\" : \"id\",           (string) The transaction id\n"
+            "    \"vout\" : n,              (numeric) The output number\n"
+            "    \"bestblock\" : \"hash\",    (string) The hash of the block at the tip of the chain\n"
+            "    ...\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("gettxouts", "\"[{\\\"txid\\\":\\\"mytxid\\\",\\\"vout\\\":0},{\\\"txid\\\":\\\"mytxid\\\",\\\"vout\\\":1}]\"")
+            + HelpExampleRpc("gettxouts", "[{\"txid\":\"mytxid\",\"vout\":0}], false")
+                },
+            }.ToString());
+
+    const UniValue& outpoints = request.params[0].get_array();
+    std::vector<COutPoint> outs;
+    outs.reserve(outpoints.size());
+    for (unsigned int idx = 0; idx < outpoints.size(); idx++) {
+        const UniValue& o = outpoints[idx].get_obj();
+        RPCTypeCheckObj(o,
+            {
+                {"txid", UniValueType(UniValue::VSTR)},
+                {"vout", UniValueType(UniValue::VNUM)},
+            });
+        const int nOutput = find_value(o, "vout").get_int();
+        if (nOutput < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, vout must be positive");
+        }
+        outs.emplace_back(ParseHashO(o, "txid"), nOutput);
+    }
+    bool fMempool = true;
+    if (!request.params[1].isNull())
+        fMempool = request.params[1].get_bool();
+
+    // Look the outputs up in key order, so that the reads of the database are sequential
+    std::vector<size_t> order(outs.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&outs](size_t a, size_t b) { return outs[a] < outs[b]; });
+
+    std::vector<Coin> coins(outs.size());
+    std::vector<bool> found(outs.size(), false);
+    uint256 best_block;
+    int best_height;
+    {
+        LOCK(cs_main);
+        const CBlockIndex* pindex = LookupBlockIndex(pcoinsTip->GetBestBlock());
+        best_block = pindex->GetBlockHash();
+        best_height = pindex->nHeight;
+        if (fMempool) {
+            LOCK(mempool.cs);
+            CCoinsViewMemPool view(pcoinsTip.get(), mempool);
+            for (size_t i : order) {
+                found[i] = view.GetCoin(outs[i], coins[i]) && !mempool.isSpent(outs[i]);
+            }
+        } else {
+            for (size_t i : order) {
+                found[i] = pcoinsTip->GetCoin(outs[i], coins[i]);
+            }
+        }
     }
-    ret.pushKV("value", ValueFromAmount(coin.out.nValue));
-    UniValue o(UniValue::VOBJ);
-    ScriptPubKeyToUniv(coin.out.scriptPubKey, o, true);
-    ret.pushKV("scriptPubKey", o);
-    ret.pushKV("coinbase", (bool)coin.fCoinBase);
 
+    UniValue ret(UniValue::VARR);
+    for (size_t i = 0; i < outs.size(); ++i) {
+        if (!found[i]) {
+            ret.push_back(NullUniValue);
+            continue;
+        }
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("txid", outs[i].hash.GetHex());
+        entry.pushKV("vout", (int64_t)outs[i].n);
+        CoinToJSON(entry, coins[i], best_block, best_height);
+        ret.push_back(entry);
+    }
     return ret;
 }
 
@@ -1546,26 +1891,16 @@ static UniValue getchaintips(const JSONRPCRequest& request)
     /*
      * Idea:  the set of chain tips is chainActive.tip, plus orphan blocks which do not have another orphan building off of them.
      * Algorithm:
-     *  - Make one pass through mapBlockIndex, picking out the orphan blocks, and also storing a set of the orphan block's pprev pointers.
-     *  - Iterate through the orphan blocks. If the block isn't pointed to by another orphan, it is a chain tip.
+     *  - The children of an orphan block are orphans as well, so these are the blocks which nothing builds on,
+     *    which are tracked in setBlockIndexLeaves, and which are not in the active chain.
      *  - add chainActive.Tip()
      */
     std::set<const CBlockIndex*, CompareBlocksByHeight> setTips;
-    std::set<const CBlockIndex*> setOrphans;
-    std::set<const CBlockIndex*> setPrevs;
-
-    for (const std::pair<const uint256, CBlockIndex*>& item : mapBlockIndex)
-    {
-        if (!chainActive.Contains(item.second)) {
-            setOrphans.insert(item.second);
-            setPrevs.insert(item.second->pprev);
-        }
-    }
 
-    for (std::set<const CBlockIndex*>::iterator it = setOrphans.begin(); it != setOrphans.end(); ++it)
+    for (const CBlockIndex* pindex : setBlockIndexLeaves)
     {
-        if (setPrevs.erase(*it) == 0) {
-            setTips.insert(*it);
+        if (!chainActive.Contains(pindex)) {
+            setTips.insert(pindex);
         }
     }
 
@@ -1651,6 +1986,39 @@ static UniValue getmempoolinfo(const JSONRPCRequest& request)
     return mempoolInfoToJSON();
 }
 
+static UniValue getblockcacheinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            RPCHelpMan{"getblockcacheinfo",
+                "\nReturns details on the cache of recently connected blocks (see -blockcachesize).\n",
+                {},
+                RPCResult{
+            "{\n"
+            "  \"size\": xxxxx,               (numeric) Number of cached blocks\n"
+            "  \"maxsize\": xxxxx,            (numeric) Maximum number of cached blocks\n"
+            "  \"hits\": xxxxx,               (numeric) Number of block reads served from the cache since startup\n"
+            "  \"misses\": xxxxx,             (numeric) Number of block reads, which had to go to disk\n"
+            "  \"hitrate\": x.xxx             (numeric) Share of block reads served from the cache\n"
+            "}\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getblockcacheinfo", "")
+            + HelpExampleRpc("getblockcacheinfo", "")
+                },
+            }.ToString());
+
+    const CBlockCache::Stats stats = g_block_cache.GetStats();
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("size", (uint64_t)stats.size);
+    ret.pushKV("maxsize", (uint64_t)stats.max_size);
+    ret.pushKV("hits", stats.hits);
+    ret.pushKV("misses", stats.misses);
+    const uint64_t reads = stats.hits + stats.misses;
+    ret.pushKV("hitrate", reads > 0 ? (double)stats.hits / reads : 0.0);
+    return ret;
+}
+
 static UniValue preciousblock(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -1891,23 +2259,98 @@ void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES],
     }
 }
 
-template<typename T>
-static inline bool SetHasKeys(const std::set<T>& set) {return false;}
-template<typename T, typename Tk, typename... Args>
-static inline bool SetHasKeys(const std::set<T>& set, const Tk& key, const Args&... args)
-{
-    return (set.count(key) != 0) || SetHasKeys(set, args...);
-}
-
 // outpoint (needed for the utxo index) + nHeight + fCoinBase
 static constexpr size_t PER_UTXO_OVERHEAD = sizeof(COutPoint) + sizeof(uint32_t) + sizeof(bool);
 
+bool ComputeBlockStats(const CBlock& block, const CBlockUndo& blockundo, CBlockStats& stats)
+{
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size()) {
+        return false;
+    }
+
+    CAmount minfee = MAX_MONEY;
+    CAmount minfeerate = MAX_MONEY;
+    int64_t mintxsize = MAX_BLOCK_SERIALIZED_SIZE;
+    std::vector<CAmount> fee_array;
+    std::vector<std::pair<CAmount, int64_t>> feerate_array;
+    std::vector<int64_t> txsize_array;
+    fee_array.reserve(block.vtx.size());
+    feerate_array.reserve(block.vtx.size());
+    txsize_array.reserve(block.vtx.size());
+
+    stats = CBlockStats();
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction& tx = *block.vtx[i];
+        stats.outputs += tx.vout.size();
+
+        CAmount tx_total_out = 0;
+        for (const CTxOut& out : tx.vout) {
+            tx_total_out += out.nValue;
+            stats.utxo_size_inc += GetSerializeSize(out, PROTOCOL_VERSION) + PER_UTXO_OVERHEAD;
+        }
+
+        if (tx.IsCoinBase()) {
+            continue;
+        }
+
+        stats.inputs += tx.vin.size(); // Don't count coinbase's fake input
+        stats.total_out += tx_total_out; // Don't count coinbase reward
+
+        const int64_t tx_size = tx.GetTotalSize();
+        txsize_array.push_back(tx_size);
+        stats.maxtxsize = std::max(stats.maxtxsize, tx_size);
+        mintxsize = std::min(mintxsize, tx_size);
+        stats.total_size += tx_size;
+
+        const int64_t weight = GetTransactionWeight(tx);
+        stats.total_weight += weight;
+
+        if (tx.HasWitness()) {
+            ++stats.swtxs;
+            stats.swtotal_size += tx_size;
+            stats.swtotal_weight += weight;
+        }
+
+        const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+        if (txundo.vprevout.size() != tx.vin.size()) {
+            return false;
+        }
+        CAmount tx_total_in = 0;
+        for (const Coin& prevout : txundo.vprevout) {
+            tx_total_in += prevout.out.nValue;
+            stats.utxo_size_inc -= GetSerializeSize(prevout.out, PROTOCOL_VERSION) + PER_UTXO_OVERHEAD;
+        }
+
+        CAmount txfee = tx_total_in - tx_total_out;
+        assert(MoneyRange(txfee));
+        fee_array.push_back(txfee);
+        stats.maxfee = std::max(stats.maxfee, txfee);
+        minfee = std::min(minfee, txfee);
+        stats.totalfee += txfee;
+
+        // New feerate uses satoshis per virtual byte instead of per serialized byte
+        CAmount feerate = weight ? (txfee * WITNESS_SCALE_FACTOR) / weight : 0;
+        feerate_array.emplace_back(std::make_pair(feerate, weight));
+        stats.maxfeerate = std::max(stats.maxfeerate, feerate);
+        minfeerate = std::min(minfeerate, feerate);
+    }
+
+    CalculatePercentilesByWeight(stats.feerate_percentiles, feerate_array, stats.total_weight);
+    stats.medianfee = CalculateTruncatedMedian(fee_array);
+    stats.mediantxsize = CalculateTruncatedMedian(txsize_array);
+    stats.minfee = (minfee == MAX_MONEY) ? 0 : minfee;
+    stats.minfeerate = (minfeerate == MAX_MONEY) ? 0 : minfeerate;
+    stats.mintxsize = (mintxsize == MAX_BLOCK_SERIALIZED_SIZE) ? 0 : mintxsize;
+    stats.txs = block.vtx.size();
+    return true;
+}
+
 static UniValue getblockstats(const JSONRPCRequest& request)
 {
     const RPCHelpMan help{"getblockstats",
                 "\nCompute per block statistics for a given window. All amounts are in satoshis.\n"
                 "It won't work for some heights with pruning.\n"
-                "It won't work without -txindex for utxo_size_inc, *fee or *feerate stats.\n",
+                "With -blockstatsindex the statistics are served from the index instead of being calculated from disk.\n",
                 {
                     {"hash_or_height", RPCArg::Type::NUM, RPCArg::Optional::NO, "The block hash or height of the target block", "", {"", "string or numeric"}},
                     {"stats", RPCArg::Type::ARR, /* default */ "all values", "Values to plot (see result below)",
@@ -1965,6 +2408,10 @@ static UniValue getblockstats(const JSONRPCRequest& request)
         throw std::runtime_error(help.ToString());
     }
 
+    if (g_blockstatsindex) {
+        g_blockstatsindex->BlockUntilSyncedToCurrentChain();
+    }
+
     LOCK(cs_main);
 
     CBlockIndex* pindex;
@@ -2001,158 +2448,52 @@ static UniValue getblockstats(const JSONRPCRequest& request)
         }
     }
 
-    const CBlock block = GetBlockChecked(pindex);
-
-    const bool do_all = stats.size() == 0; // Calculate everything if nothing selected (default)
-    const bool do_mediantxsize = do_all || stats.count("mediantxsize") != 0;
-    const bool do_medianfee = do_all || stats.count("medianfee") != 0;
-    const bool do_feerate_percentiles = do_all || stats.count("feerate_percentiles") != 0;
-    const bool loop_inputs = do_all || do_medianfee || do_feerate_percentiles ||
-        SetHasKeys(stats, "utxo_size_inc", "totalfee", "avgfee", "avgfeerate", "minfee", "maxfee", "minfeerate", "maxfeerate");
-    const bool loop_outputs = do_all || loop_inputs || stats.count("total_out");
-    const bool do_calculate_size = do_mediantxsize ||
-        SetHasKeys(stats, "total_size", "avgtxsize", "mintxsize", "maxtxsize", "swtotal_size");
-    const bool do_calculate_weight = do_all || SetHasKeys(stats, "total_weight", "avgfeerate", "swtotal_weight", "avgfeerate", "feerate_percentiles", "minfeerate", "maxfeerate");
-    const bool do_calculate_sw = do_all || SetHasKeys(stats, "swtxs", "swtotal_size", "swtotal_weight");
-
-    if (loop_inputs && !g_txindex) {
-        throw JSONRPCError(RPC_INVALID_PARAMETER, "One or more of the selected stats requires -txindex enabled");
-    }
-
-    CAmount maxfee = 0;
-    CAmount maxfeerate = 0;
-    CAmount minfee = MAX_MONEY;
-    CAmount minfeerate = MAX_MONEY;
-    CAmount total_out = 0;
-    CAmount totalfee = 0;
-    int64_t inputs = 0;
-    int64_t maxtxsize = 0;
-    int64_t mintxsize = MAX_BLOCK_SERIALIZED_SIZE;
-    int64_t outputs = 0;
-    int64_t swtotal_size = 0;
-    int64_t swtotal_weight = 0;
-    int64_t swtxs = 0;
-    int64_t total_size = 0;
-    int64_t total_weight = 0;
-    int64_t utxo_size_inc = 0;
-    std::vector<CAmount> fee_array;
-    std::vector<std::pair<CAmount, int64_t>> feerate_array;
-    std::vector<int64_t> txsize_array;
-
-    for (const auto& tx : block.vtx) {
-        outputs += tx->vout.size();
-
-        CAmount tx_total_out = 0;
-        if (loop_outputs) {
-            for (const CTxOut& out : tx->vout) {
-                tx_total_out += out.nValue;
-                utxo_size_inc += GetSerializeSize(out, PROTOCOL_VERSION) + PER_UTXO_OVERHEAD;
-            }
-        }
-
-        if (tx->IsCoinBase()) {
-            continue;
-        }
-
-        inputs += tx->vin.size(); // Don't count coinbase's fake input
-        total_out += tx_total_out; // Don't count coinbase reward
-
-        int64_t tx_size = 0;
-        if (do_calculate_size) {
-
-            tx_size = tx->GetTotalSize();
-            if (do_mediantxsize) {
-                txsize_array.push_back(tx_size);
-            }
-            maxtxsize = std::max(maxtxsize, tx_size);
-            mintxsize = std::min(mintxsize, tx_size);
-            total_size += tx_size;
-        }
-
-        int64_t weight = 0;
-        if (do_calculate_weight) {
-            weight = GetTransactionWeight(*tx);
-            total_weight += weight;
-        }
-
-        if (do_calculate_sw && tx->HasWitness()) {
-            ++swtxs;
-            swtotal_size += tx_size;
-            swtotal_weight += weight;
-        }
-
-        if (loop_inputs) {
-            CAmount tx_total_in = 0;
-            for (const CTxIn& in : tx->vin) {
-                CTransactionRef tx_in;
-                uint256 hashBlock;
-                if (!GetTransaction(in.prevout.hash, tx_in, Params().GetConsensus(), hashBlock)) {
-                    throw JSONRPCError(RPC_INTERNAL_ERROR, std::string("Unexpected internal error (tx index seems corrupt)"));
-                }
-
-                CTxOut prevoutput = tx_in->vout[in.prevout.n];
-
-                tx_total_in += prevoutput.nValue;
-                utxo_size_inc -= GetSerializeSize(prevoutput, PROTOCOL_VERSION) + PER_UTXO_OVERHEAD;
-            }
-
-            CAmount txfee = tx_total_in - tx_total_out;
-            assert(MoneyRange(txfee));
-            if (do_medianfee) {
-                fee_array.push_back(txfee);
-            }
-            maxfee = std::max(maxfee, txfee);
-            minfee = std::min(minfee, txfee);
-            totalfee += txfee;
-
-            // New feerate uses satoshis per virtual byte instead of per serialized byte
-            CAmount feerate = weight ? (txfee * WITNESS_SCALE_FACTOR) / weight : 0;
-            if (do_feerate_percentiles) {
-                feerate_array.emplace_back(std::make_pair(feerate, weight));
-            }
-            maxfeerate = std::max(maxfeerate, feerate);
-            minfeerate = std::min(minfeerate, feerate);
+    CBlockStats block_stats;
+    if (!g_blockstatsindex || !g_blockstatsindex->LookupStats(pindex, block_stats)) {
+        const CBlock block = GetBlockChecked(pindex);
+        const CBlockUndo blockundo = GetUndoChecked(pindex);
+        if (!ComputeBlockStats(block, blockundo, block_stats)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Undo data does not match block");
         }
     }
 
-    CAmount feerate_percentiles[NUM_GETBLOCKSTATS_PERCENTILES] = { 0 };
-    CalculatePercentilesByWeight(feerate_percentiles, feerate_array, total_weight);
+    const bool do_all = stats.size() == 0; // Calculate everything if nothing selected (default)
 
     UniValue feerates_res(UniValue::VARR);
     for (int64_t i = 0; i < NUM_GETBLOCKSTATS_PERCENTILES; i++) {
-        feerates_res.push_back(feerate_percentiles[i]);
+        feerates_res.push_back(block_stats.feerate_percentiles[i]);
     }
 
     UniValue ret_all(UniValue::VOBJ);
-    ret_all.pushKV("avgfee", (block.vtx.size() > 1) ? totalfee / (block.vtx.size() - 1) : 0);
-    ret_all.pushKV("avgfeerate", total_weight ? (totalfee * WITNESS_SCALE_FACTOR) / total_weight : 0); // Unit: sat/vbyte
-    ret_all.pushKV("avgtxsize", (block.vtx.size() > 1) ? total_size / (block.vtx.size() - 1) : 0);
+    ret_all.pushKV("avgfee", (block_stats.txs > 1) ? block_stats.totalfee / (block_stats.txs - 1) : 0);
+    ret_all.pushKV("avgfeerate", block_stats.total_weight ? (block_stats.totalfee * WITNESS_SCALE_FACTOR) / block_stats.total_weight : 0); // Unit: sat/vbyte
+    ret_all.pushKV("avgtxsize", (block_stats.txs > 1) ? block_stats.total_size / (block_stats.txs - 1) : 0);
     ret_all.pushKV("blockhash", pindex->GetBlockHash().GetHex());
     ret_all.pushKV("feerate_percentiles", feerates_res);
     ret_all.pushKV("height", (int64_t)pindex->nHeight);
-    ret_all.pushKV("ins", inputs);
-    ret_all.pushKV("maxfee", maxfee);
-    ret_all.pushKV("maxfeerate", maxfeerate);
-    ret_all.pushKV("maxtxsize", maxtxsize);
-    ret_all.pushKV("medianfee", CalculateTruncatedMedian(fee_array));
+    ret_all.pushKV("ins", block_stats.inputs);
+    ret_all.pushKV("maxfee", block_stats.maxfee);
+    ret_all.pushKV("maxfeerate", block_stats.maxfeerate);
+    ret_all.pushKV("maxtxsize", block_stats.maxtxsize);
+    ret_all.pushKV("medianfee", block_stats.medianfee);
     ret_all.pushKV("mediantime", pindex->GetMedianTimePast());
-    ret_all.pushKV("mediantxsize", CalculateTruncatedMedian(txsize_array));
-    ret_all.pushKV("minfee", (minfee == MAX_MONEY) ? 0 : minfee);
-    ret_all.pushKV("minfeerate", (minfeerate == MAX_MONEY) ? 0 : minfeerate);
-    ret_all.pushKV("mintxsize", mintxsize == MAX_BLOCK_SERIALIZED_SIZE ? 0 : mintxsize);
-    ret_all.pushKV("outs", outputs);
+    ret_all.pushKV("mediantxsize", block_stats.mediantxsize);
+    ret_all.pushKV("minfee", block_stats.minfee);
+    ret_all.pushKV("minfeerate", block_stats.minfeerate);
+    ret_all.pushKV("mintxsize", block_stats.mintxsize);
+    ret_all.pushKV("outs", block_stats.outputs);
     ret_all.pushKV("subsidy", GetBlockSubsidy(pindex->nHeight, Params().GetConsensus()));
-    ret_all.pushKV("swtotal_size", swtotal_size);
-    ret_all.pushKV("swtotal_weight", swtotal_weight);
-    ret_all.pushKV("swtxs", swtxs);
+    ret_all.pushKV("swtotal_size", block_stats.swtotal_size);
+    ret_all.pushKV("swtotal_weight", block_stats.swtotal_weight);
+    ret_all.pushKV("swtxs", block_stats.swtxs);
     ret_all.pushKV("time", pindex->GetBlockTime());
-    ret_all.pushKV("total_out", total_out);
-    ret_all.pushKV("total_size", total_size);
-    ret_all.pushKV("total_weight", total_weight);
-    ret_all.pushKV("totalfee", totalfee);
-    ret_all.pushKV("txs", (int64_t)block.vtx.size());
-    ret_all.pushKV("utxo_increase", outputs - inputs);
-    ret_all.pushKV("utxo_size_inc", utxo_size_inc);
+    ret_all.pushKV("total_out", block_stats.total_out);
+    ret_all.pushKV("total_size", block_stats.total_size);
+    ret_all.pushKV("total_weight", block_stats.total_weight);
+    ret_all.pushKV("totalfee", block_stats.totalfee);
+    ret_all.pushKV("txs", block_stats.txs);
+    ret_all.pushKV("utxo_increase", block_stats.outputs - block_stats.inputs);
+    ret_all.pushKV("utxo_size_inc", block_stats.utxo_size_inc);
 
     if (do_all) {
         return ret_all;
@@ -2195,33 +2536,106 @@ static UniValue savemempool(const JSONRPCRequest& request)
     return NullUniValue;
 }
 
-//! Search for a given set of pubkey scripts
-bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, CCoinsViewCursor* cursor, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results) {
-    scan_progress = 0;
-    count = 0;
+//! Maximum number of threads used to scan the txout set
+static const int MAX_SCANTXOUTSET_THREADS = 8;
+
+typedef std::unordered_set<CScript, SaltedScriptHasher> ScriptPubKeySet;
+
+/** A range of the txout set, whose txids start with a byte in [first_byte, end_byte). */
+struct TxOutSetScanPartition
+{
+    int first_byte;
+    int end_byte;
+    std::unique_ptr<CCoinsViewCursor> cursor;
+    int64_t count = 0;
+    bool success = false;
+    std::map<COutPoint, Coin> results;
+};
+
+//! Search for a given set of pubkey scripts within one partition of the txout set
+static void ScanPartition(std::atomic<uint32_t>& scanned_prefixes, const std::atomic<bool>& should_abort, std::atomic<bool>& failed, TxOutSetScanPartition& partition, const ScriptPubKeySet& needles) {
+    // progress is accounted in 16 bit txid prefixes, of which the whole set has 65536
+    uint32_t last_prefix = partition.first_byte << 8;
+    CCoinsViewCursor* cursor = partition.cursor.get();
     while (cursor->Valid()) {
         COutPoint key;
         Coin coin;
-        if (!cursor->GetKey(key) || !cursor->GetValue(coin)) return false;
-        if (++count % 8192 == 0) {
-            boost::this_thread::interruption_point();
-            if (should_abort) {
-                // allow to abort the scan via the abort reference
-                return false;
+        if (!cursor->GetKey(key)) break;
+        if (*key.hash.begin() >= partition.end_byte) break;
+        if (!cursor->GetValue(coin)) {
+            failed = true;
+            return;
+        }
+        if (++partition.count % 8192 == 0) {
+            if (should_abort || failed || ShutdownRequested()) {
+                // allow to abort the scan via the abort reference, or by shutting down
+                return;
             }
         }
-        if (count % 256 == 0) {
-            // update progress reference every 256 item
+        if (partition.count % 256 == 0) {
+            // account the scanned prefixes every 256 item
             uint32_t high = 0x100 * *key.hash.begin() + *(key.hash.begin() + 1);
-            scan_progress = (int)(high * 100.0 / 65536.0 + 0.5);
+            if (high > last_prefix) {
+                scanned_prefixes += high - last_prefix;
+                last_prefix = high;
+            }
         }
         if (needles.count(coin.out.scriptPubKey)) {
-            out_results.emplace(key, coin);
+            partition.results.emplace(key, coin);
         }
         cursor->Next();
     }
-    scan_progress = 100;
-    return true;
+    scanned_prefixes += (partition.end_byte << 8) - last_prefix;
+    partition.success = true;
+}
+
+/**
+ * Search for a given set of pubkey scripts in the txout set.
+ *
+ * The key space of the coins database is split into disjoint ranges of txid
+ * prefixes, which are scanned by separate threads. All cursors must have been
+ * created while holding cs_main, so that they see the same state. The calling
+ * thread updates the progress reference, while it waits for the scan.
+ */
+static bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, std::vector<TxOutSetScanPartition>& partitions, const ScriptPubKeySet& needles, std::map<COutPoint, Coin>& out_results) {
+    scan_progress = 0;
+    count = 0;
+    std::atomic<uint32_t> scanned_prefixes(0);
+    std::atomic<bool> failed(false);
+
+    std::mutex finished_mutex;
+    std::condition_variable finished_cv;
+    size_t finished = 0;
+
+    std::vector<std::thread> threads;
+    threads.reserve(partitions.size());
+    for (TxOutSetScanPartition& partition : partitions) {
+        threads.emplace_back([&] {
+            ScanPartition(scanned_prefixes, should_abort, failed, partition, needles);
+            std::lock_guard<std::mutex> lock(finished_mutex);
+            ++finished;
+            finished_cv.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(finished_mutex);
+        while (finished < threads.size()) {
+            finished_cv.wait_for(lock, std::chrono::milliseconds(100));
+            scan_progress = (int)(scanned_prefixes * 100.0 / 65536.0 + 0.5);
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    bool success = true;
+    for (TxOutSetScanPartition& partition : partitions) {
+        count += partition.count;
+        success &= partition.success;
+        out_results.insert(partition.results.begin(), partition.results.end());
+    }
+    if (success) scan_progress = 100;
+    return success;
 }
 
 /** RAII object to prevent concurrency issue when scanning the txout set */
@@ -2335,7 +2749,7 @@ UniValue scantxoutset(const JSONRPCRequest& request)
         if (!reserver.reserve()) {
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Scan already in progress, use action \"abort\" or \"status\"");
         }
-        std::set<CScript> needles;
+        ScriptPubKeySet needles;
         std::map<CScript, std::string> descriptors;
         CAmount total_in = 0;
 
@@ -2387,14 +2801,22 @@ UniValue scantxoutset(const JSONRPCRequest& request)
         g_should_abort_scan = false;
         g_scan_progress = 0;
         int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
+        const int num_partitions = std::max(1, std::min(GetNumCores(), MAX_SCANTXOUTSET_THREADS));
+        std::vector<TxOutSetScanPartition> partitions(num_partitions);
         {
             LOCK(cs_main);
             FlushStateToDisk();
-            pcursor = std::unique_ptr<CCoinsViewCursor>(pcoinsdbview->Cursor());
-            assert(pcursor);
+            for (int i = 0; i < num_partitions; ++i) {
+                TxOutSetScanPartition& partition = partitions[i];
+                partition.first_byte = 256 * i / num_partitions;
+                partition.end_byte = 256 * (i + 1) / num_partitions;
+                uint256 start;
+                *start.begin() = partition.first_byte;
+                partition.cursor = std::unique_ptr<CCoinsViewCursor>(pcoinsdbview->Cursor(start));
+                assert(partition.cursor);
+            }
         }
-        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles, coins);
+        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, partitions, needles, coins);
         result.pushKV("success", res);
         result.pushKV("searched_items", count);
 
@@ -2442,11 +2864,13 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempoolancestors",    &getmempoolancestors,    {"txid","verbose"} },
     { "blockchain",         "getmempooldescendants",  &getmempooldescendants,  {"txid","verbose"} },
     { "blockchain",         "getmempoolentry",        &getmempoolentry,        {"txid"} },
+    { "blockchain",         "getblockcacheinfo",      &getblockcacheinfo,      {} },
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         {} },
     { "blockchain",         "clearmempool",           &clearmempool,           {} },
-    { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose"} },
+    { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose","start","count"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
+    { "blockchain",         "gettxouts",              &gettxouts,              {"outpoints","include_mempool"} },
+    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
@@ -8,9 +8,12 @@
 #include <vector>
 #include <stdint.h>
 #include <amount.h>
+#include <serialize.h>
+#include <uint256.h>
 
 class CBlock;
 class CBlockIndex;
+class CBlockUndo;
 class UniValue;
 
 static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
@@ -32,8 +35,8 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
 /** Mempool information to JSON */
 UniValue mempoolInfoToJSON();
 
-/** Mempool to JSON */
-UniValue mempoolToJSON(bool fVerbose = false);
+/** Mempool to JSON, optionally paginated by txid (at most count entries after start) */
+UniValue mempoolToJSON(bool fVerbose = false, const uint256& start = uint256(), size_t count = 0);
 
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex);
@@ -41,4 +44,63 @@ UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex
 /** Used by getblockstats to get feerates at different percentiles by weight  */
 void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
 
+/** Statistics about the transactions of a block, as reported by getblockstats */
+struct CBlockStats
+{
+    CAmount maxfee = 0;
+    CAmount maxfeerate = 0;
+    CAmount medianfee = 0;
+    CAmount minfee = 0;
+    CAmount minfeerate = 0;
+    CAmount total_out = 0;
+    CAmount totalfee = 0;
+    CAmount feerate_percentiles[NUM_GETBLOCKSTATS_PERCENTILES] = { 0 };
+    int64_t inputs = 0;
+    int64_t maxtxsize = 0;
+    int64_t mediantxsize = 0;
+    int64_t mintxsize = 0;
+    int64_t outputs = 0;
+    int64_t swtotal_size = 0;
+    int64_t swtotal_weight = 0;
+    int64_t swtxs = 0;
+    int64_t total_size = 0;
+    int64_t total_weight = 0;
+    int64_t txs = 0;
+    int64_t utxo_size_inc = 0;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(VARINT(maxfee, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(maxfeerate, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(medianfee, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(minfee, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(minfeerate, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(total_out, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(totalfee, VarIntMode::NONNEGATIVE_SIGNED));
+        for (int i = 0; i < NUM_GETBLOCKSTATS_PERCENTILES; i++) {
+            READWRITE(VARINT(feerate_percentiles[i], VarIntMode::NONNEGATIVE_SIGNED));
+        }
+        READWRITE(VARINT(inputs, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(maxtxsize, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(mediantxsize, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(mintxsize, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(outputs, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(swtotal_size, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(swtotal_weight, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(swtxs, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(total_size, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(total_weight, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(VARINT(txs, VarIntMode::NONNEGATIVE_SIGNED));
+        READWRITE(utxo_size_inc); // can be negative
+    }
+};
+
+/**
+ * Calculate the statistics of a block from the block and its undo data.
+ * Returns false if the undo data does not belong to the block.
+ */
+bool ComputeBlockStats(const CBlock& block, const CBlockUndo& blockundo, CBlockStats& stats);
+
 #endif
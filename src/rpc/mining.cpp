@@ -28,8 +28,12 @@
 #include <versionbitsinfo.h>
 #include <warnings.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <stdint.h>
+#include <thread>
+#include <vector>
 
 /**
  * Return average network hashes per second based on the last 'lookup' blocks,
@@ -98,12 +102,55 @@ static UniValue getnetworkhashps(const JSONRPCRequest& request)
     return GetNetworkHashPS(!request.params[0].isNull() ? request.params[0].get_int() : 120, !request.params[1].isNull() ? request.params[1].get_int() : -1);
 }
 
+/**
+ * Searches the lowest nonce in [header.nNonce, nNonceEnd), with which the
+ * block header satisfies the proof of work.
+ *
+ * The nonces are handed out in ascending order to nThreads threads, the
+ * calling thread included. A thread stops once a lower solution was found,
+ * so the result is the same as the one of a sequential search.
+ *
+ * @return The found nonce, or nNonceEnd, if there is none
+ */
+static uint32_t FindNonce(const CBlockHeader& header, unsigned int profile, uint32_t nNonceEnd, int nThreads)
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    std::atomic<uint32_t> nNext{header.nNonce};
+    std::atomic<uint32_t> nFound{nNonceEnd};
+
+    auto search = [&]() {
+        CBlockHeader candidate = header;
+        uint32_t nNonce;
+        while ((nNonce = nNext++) < nFound) {
+            candidate.nNonce = nNonce;
+            if (CheckProofOfWork(candidate.GetPoWHash(profile), candidate.nBits, consensusParams)) {
+                uint32_t nPrev = nFound;
+                while (nNonce < nPrev && !nFound.compare_exchange_weak(nPrev, nNonce)) {}
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < nThreads; ++i) {
+        threads.emplace_back(search);
+    }
+    search();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    return nFound;
+}
+
 UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGenerate, uint64_t nMaxTries, bool keepScript)
 {
     static const int nInnerLoopCount = 0x10000;
     int nHeightEnd = 0;
     int nHeight = 0;
     unsigned int profile = 0x3;
+    // the nonce search uses as many threads as script verification (-par)
+    const int nThreads = std::max(1, nScriptCheckThreads);
 
     {   // Don't keep cs_main locked
         LOCK(cs_main);
@@ -124,10 +171,10 @@ UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGen
         }
         if (pblock->GetBlockTime() >= Params().GetConsensus().nNeoScryptFork)
             profile = 0x0;
-        while (nMaxTries > 0 && pblock->nNonce < nInnerLoopCount && !CheckProofOfWork(pblock->GetPoWHash(profile), pblock->nBits, Params().GetConsensus())) {
-            ++pblock->nNonce;
-            --nMaxTries;
-        }
+        const uint32_t nNonceEnd = std::min<uint64_t>(nInnerLoopCount, pblock->nNonce + nMaxTries);
+        const uint32_t nNonce = FindNonce(*pblock, profile, nNonceEnd, nThreads);
+        nMaxTries -= nNonce - pblock->nNonce;
+        pblock->nNonce = nNonce;
         if (nMaxTries == 0) {
             break;
         }
@@ -214,6 +214,152 @@ static UniValue getrawtransaction(const JSONRPCRequest& request)
     return result;
 }
 
+static UniValue getrawtransactions(const JSONRPCRequest& request)
+{
+    const RPCHelpMan help{
+                "getrawtransactions",
+                "\nReturn the raw data of several transactions at once.\n"
+
+                "\nThe transactions are looked up like with getrawtransaction. Transactions, which are not\n"
+                "in the mempool, are read from disk in the order they are stored in, and a block given with\n"
+                "blockhash is only read once.\n",
+                {
+                    {"txids", RPCArg::Type::ARR, RPCArg::Optional::NO, "A json array of transaction ids",
+                        {
+                            {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "A transaction id"},
+                        },
+                    },
+                    {"verbose", RPCArg::Type::BOOL, /* default */ "false", "If false, return the hex-encoded data of each transaction, otherwise a json object like getrawtransaction"},
+                    {"blockhash", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED_NAMED_ARG, "The block in which to look for the transactions"},
+                },
+                RPCResult{
+            "[                       (array of json objects) In the same order as txids\n"
+            "  {\n"
+            "    \"txid\" : \"id\",      (string) The transaction id\n"
+            "    \"hex\" : \"data\",     (string) The serialized, hex-encoded data for 'txid'\n"
+            "    ...                 If verbose is set to true, the same fields as getrawtransaction\n"
+            "  }\n"
+            "  ,{                    Or, if the transaction was not found:\n"
+            "    \"txid\" : \"id\",      (string) The transaction id\n"
+            "    \"error\" : {          (json object) The error getrawtransaction would fail with\n"
+            "      \"code\" : n,        (numeric) The error code\n"
+            "      \"message\" : \"msg\" (string) The error message\n"
+            "    }\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getrawtransactions", "\"[\\\"mytxid\\\",\\\"mytxid2\\\"]\"")
+            + HelpExampleCli("getrawtransactions", "\"[\\\"mytxid\\\",\\\"mytxid2\\\"]\" true \"myblockhash\"")
+            + HelpExampleRpc("getrawtransactions", "[\"mytxid\",\"mytxid2\"], true")
+                },
+    };
+
+    if (request.fHelp || !help.IsValidNumArgs(request.params.size())) {
+        throw std::runtime_error(help.ToString());
+    }
+
+    const UniValue& txids = request.params[0].get_array();
+    std::vector<uint256> hashes;
+    hashes.reserve(txids.size());
+    for (unsigned int idx = 0; idx < txids.size(); idx++) {
+        hashes.push_back(ParseHashV(txids[idx], "txid"));
+    }
+
+    // Accept either a bool (true) or a num (>=1) to indicate verbose output.
+    bool fVerbose = false;
+    if (!request.params[1].isNull()) {
+        fVerbose = request.params[1].isNum() ? (request.params[1].get_int() != 0) : request.params[1].get_bool();
+    }
+
+    std::vector<CTransactionRef> txs(hashes.size());
+    std::vector<uint256> hash_blocks(hashes.size());
+    std::string errmsg;
+    bool in_active_chain = true;
+    const bool by_block = !request.params[2].isNull();
+
+    if (by_block) {
+        CBlock block;
+        uint256 blockhash = ParseHashV(request.params[2], "parameter 3");
+        {
+            LOCK(cs_main);
+            const CBlockIndex* blockindex = LookupBlockIndex(blockhash);
+            if (!blockindex) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block hash not found");
+            }
+            if (!(blockindex->nStatus & BLOCK_HAVE_DATA)) {
+                throw JSONRPCError(RPC_MISC_ERROR, "Block not available");
+            }
+            in_active_chain = chainActive.Contains(blockindex);
+            if (!ReadBlockFromDisk(block, blockindex, Params().GetConsensus())) {
+                throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+            }
+        }
+        std::map<uint256, CTransactionRef> block_txs;
+        for (const auto& tx : block.vtx) {
+            block_txs.emplace(tx->GetHash(), tx);
+        }
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            auto it = block_txs.find(hashes[i]);
+            if (it != block_txs.end()) {
+                txs[i] = it->second;
+                hash_blocks[i] = blockhash;
+            }
+        }
+        errmsg = "No such transaction found in the provided block";
+    } else {
+        std::vector<uint256> missing;
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            txs[i] = mempool.get(hashes[i]);
+            if (!txs[i]) missing.push_back(hashes[i]);
+        }
+
+        bool f_txindex_ready = false;
+        if (g_txindex && !missing.empty()) {
+            f_txindex_ready = g_txindex->BlockUntilSyncedToCurrentChain();
+
+            std::vector<uint256> missing_hash_blocks;
+            std::vector<CTransactionRef> missing_txs;
+            g_txindex->FindTxs(missing, missing_hash_blocks, missing_txs);
+            for (size_t i = 0, j = 0; i < hashes.size(); ++i) {
+                if (txs[i]) continue;
+                txs[i] = missing_txs[j];
+                hash_blocks[i] = missing_hash_blocks[j];
+                ++j;
+            }
+        }
+
+        if (!g_txindex) {
+            errmsg = "No such mempool transaction. Use -txindex to enable blockchain transaction queries";
+        } else if (!f_txindex_ready) {
+            errmsg = "No such mempool transaction. Blockchain transactions are still in the process of being indexed";
+        } else {
+            errmsg = "No such mempool or blockchain transaction";
+        }
+    }
+
+    UniValue result(UniValue::VARR);
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        UniValue entry(UniValue::VOBJ);
+        if (hashes[i] == Params().GenesisBlock().hashMerkleRoot) {
+            entry.pushKV("txid", hashes[i].GetHex());
+            entry.pushKV("error", JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "The genesis block coinbase is not considered an ordinary transaction and cannot be retrieved"));
+        } else if (!txs[i]) {
+            entry.pushKV("txid", hashes[i].GetHex());
+            entry.pushKV("error", JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, errmsg + (by_block ? "" : ". Use gettransaction for wallet transactions.")));
+        } else if (!fVerbose) {
+            entry.pushKV("txid", hashes[i].GetHex());
+            entry.pushKV("hex", EncodeHexTx(*txs[i], RPCSerializationFlags()));
+        } else {
+            if (by_block) entry.pushKV("in_active_chain", in_active_chain);
+            TxToJSON(*txs[i], hash_blocks[i], entry);
+        }
+        result.push_back(entry);
+    }
+    return result;
+}
+
 static UniValue gettxoutproof(const JSONRPCRequest& request)
 {
     if (request.fHelp || (request.params.size() != 1 && request.params.size() != 2))
@@ -2153,6 +2299,7 @@ static const CRPCCommand commands[] =
 { //  category              name                            actor (function)            argNames
   //  --------------------- ------------------------        -----------------------     ----------
     { "rawtransactions",    "getrawtransaction",            &getrawtransaction,         {"txid","verbose","blockhash"} },
+    { "rawtransactions",    "getrawtransactions",           &getrawtransactions,        {"txids","verbose","blockhash"} },
     { "rawtransactions",    "createrawtransaction",         &createrawtransaction,      {"inputs","outputs","locktime","replaceable"} },
     { "rawtransactions",    "decoderawtransaction",         &decoderawtransaction,      {"hexstring","iswitness"} },
     { "rawtransactions",    "decodescript",                 &decodescript,              {"hexstring"} },
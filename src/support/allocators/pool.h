@@ -0,0 +1,201 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SUPPORT_ALLOCATORS_POOL_H
+#define BITCOIN_SUPPORT_ALLOCATORS_POOL_H
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <array>
+#include <list>
+#include <new>
+#include <type_traits>
+
+/**
+ * Memory resource, which serves small allocations of node based containers
+ * from large chunks.
+ *
+ * Requests of up to MAX_BLOCK_SIZE_BYTES are rounded up to a multiple of
+ * ALIGN_BYTES, and carved out of the current chunk. Freed blocks are kept in
+ * a free list per size, and reused by later requests of the same size. This
+ * avoids the per allocation overhead of malloc, and makes allocating and
+ * freeing a constant time pointer operation. Chunks are allocated on first
+ * use, and only given back when the resource is destroyed. Larger requests, like the bucket array of a hash
+ * table, are passed on to operator new.
+ *
+ * Not thread-safe, the resource must be protected like the container using it.
+ */
+template <size_t MAX_BLOCK_SIZE_BYTES, size_t ALIGN_BYTES>
+class PoolResource
+{
+    static_assert(ALIGN_BYTES > 0 && (ALIGN_BYTES & (ALIGN_BYTES - 1)) == 0, "ALIGN_BYTES must be a power of two");
+    static_assert(ALIGN_BYTES >= sizeof(void*), "a free block must be able to hold the free list pointer");
+    static_assert(ALIGN_BYTES <= alignof(max_align_t), "chunks are only aligned to max_align_t");
+
+    //! A free block, which links to the next free block of the same size
+    struct ListNode
+    {
+        ListNode* m_next;
+    };
+
+    //! Size of the chunks to carve the blocks from
+    const size_t m_chunk_size_bytes;
+
+    //! All chunks allocated so far, they are freed when the resource is destroyed
+    std::list<void*> m_allocated_chunks;
+
+    //! Free lists, indexed by the block size in multiples of ALIGN_BYTES
+    std::array<ListNode*, MAX_BLOCK_SIZE_BYTES / ALIGN_BYTES + 1> m_free_lists;
+
+    //! Unused part of the current chunk
+    char* m_available_memory_it;
+    char* m_available_memory_end;
+
+    static size_t NumElemAlignBytes(size_t bytes)
+    {
+        return (bytes + ALIGN_BYTES - 1) / ALIGN_BYTES + (bytes == 0);
+    }
+
+    static bool IsFreeListUsable(size_t bytes, size_t alignment)
+    {
+        return alignment <= ALIGN_BYTES && bytes <= MAX_BLOCK_SIZE_BYTES;
+    }
+
+    void AddToFreeList(void* p, size_t num_align)
+    {
+        m_free_lists[num_align] = new (p) ListNode{m_free_lists[num_align]};
+    }
+
+    void AllocateChunk()
+    {
+        // The rest of the current chunk is too small for the request, keep it for smaller ones
+        const size_t remaining_available_bytes = m_available_memory_end - m_available_memory_it;
+        if (remaining_available_bytes > 0) {
+            AddToFreeList(m_available_memory_it, remaining_available_bytes / ALIGN_BYTES);
+        }
+
+        void* storage = ::operator new(m_chunk_size_bytes);
+        m_available_memory_it = static_cast<char*>(storage);
+        m_available_memory_end = m_available_memory_it + m_chunk_size_bytes;
+        m_allocated_chunks.push_back(storage);
+    }
+
+public:
+    explicit PoolResource(size_t chunk_size_bytes = 1 << 18)
+        : m_chunk_size_bytes(NumElemAlignBytes(chunk_size_bytes) * ALIGN_BYTES),
+          m_free_lists(), m_available_memory_it(nullptr), m_available_memory_end(nullptr)
+    {
+        assert(m_chunk_size_bytes >= MAX_BLOCK_SIZE_BYTES);
+    }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    ~PoolResource()
+    {
+        for (void* chunk : m_allocated_chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    void* Allocate(size_t bytes, size_t alignment)
+    {
+        if (!IsFreeListUsable(bytes, alignment)) {
+            return ::operator new(bytes);
+        }
+
+        const size_t num_align = NumElemAlignBytes(bytes);
+        if (m_free_lists[num_align] != nullptr) {
+            ListNode* node = m_free_lists[num_align];
+            m_free_lists[num_align] = node->m_next;
+            return node;
+        }
+
+        const size_t round_bytes = num_align * ALIGN_BYTES;
+        if (round_bytes > static_cast<size_t>(m_available_memory_end - m_available_memory_it)) {
+            AllocateChunk();
+        }
+        void* p = m_available_memory_it;
+        m_available_memory_it += round_bytes;
+        return p;
+    }
+
+    void Deallocate(void* p, size_t bytes, size_t alignment) noexcept
+    {
+        if (!IsFreeListUsable(bytes, alignment)) {
+            ::operator delete(p);
+            return;
+        }
+        AddToFreeList(p, NumElemAlignBytes(bytes));
+    }
+
+    size_t NumAllocatedChunks() const
+    {
+        return m_allocated_chunks.size();
+    }
+
+    size_t ChunkSizeBytes() const
+    {
+        return m_chunk_size_bytes;
+    }
+};
+
+/**
+ * Allocator, which takes its memory from a PoolResource. Containers using
+ * it have to be constructed with a pointer to the resource, which must
+ * outlive them.
+ */
+template <class T, size_t MAX_BLOCK_SIZE_BYTES, size_t ALIGN_BYTES = alignof(void*)>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+    typedef PoolResource<MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> ResourceType;
+
+    //! Swapped containers keep using the pool their nodes were allocated from
+    typedef std::true_type propagate_on_container_swap;
+
+    template <class U>
+    struct rebind {
+        typedef PoolAllocator<U, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> other;
+    };
+
+    PoolAllocator(ResourceType* resource) noexcept : m_resource(resource) {}
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& other) noexcept : m_resource(other.resource()) {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(m_resource->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        m_resource->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    ResourceType* resource() const noexcept
+    {
+        return m_resource;
+    }
+
+private:
+    ResourceType* m_resource;
+};
+
+template <class T1, class T2, size_t MAX_BLOCK_SIZE_BYTES, size_t ALIGN_BYTES>
+bool operator==(const PoolAllocator<T1, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& a, const PoolAllocator<T2, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& b) noexcept
+{
+    return a.resource() == b.resource();
+}
+
+template <class T1, class T2, size_t MAX_BLOCK_SIZE_BYTES, size_t ALIGN_BYTES>
+bool operator!=(const PoolAllocator<T1, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& a, const PoolAllocator<T2, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& b) noexcept
+{
+    return !(a == b);
+}
+
+#endif // BITCOIN_SUPPORT_ALLOCATORS_POOL_H
@@ -0,0 +1,81 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <blockcache.h>
+#include <test/test_bitcoin.h>
+
+#include <memory>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockcache_tests, BasicTestingSetup)
+
+static std::shared_ptr<const CBlock> MakeBlock(uint32_t nonce)
+{
+    auto block = std::make_shared<CBlock>();
+    block->nNonce = nonce;
+    return block;
+}
+
+BOOST_AUTO_TEST_CASE(blockcache_lru)
+{
+    CBlockCache cache(2);
+    const uint256 hash1 = uint256S("01");
+    const uint256 hash2 = uint256S("02");
+    const uint256 hash3 = uint256S("03");
+
+    cache.Insert(hash1, MakeBlock(1));
+    cache.Insert(hash2, MakeBlock(2));
+    BOOST_CHECK_EQUAL(cache.GetStats().size, 2U);
+
+    // Reading hash1 makes hash2 the least recently used block
+    BOOST_CHECK_EQUAL(cache.Get(hash1)->nNonce, 1U);
+    cache.Insert(hash3, MakeBlock(3));
+    BOOST_CHECK_EQUAL(cache.GetStats().size, 2U);
+    BOOST_CHECK(cache.Get(hash2) == nullptr);
+    BOOST_CHECK_EQUAL(cache.Get(hash1)->nNonce, 1U);
+    BOOST_CHECK_EQUAL(cache.Get(hash3)->nNonce, 3U);
+
+    // Inserting a cached block again refreshes it, but keeps the old entry
+    cache.Insert(hash1, MakeBlock(4));
+    cache.Insert(hash2, MakeBlock(2));
+    BOOST_CHECK(cache.Get(hash3) == nullptr);
+    BOOST_CHECK_EQUAL(cache.Get(hash1)->nNonce, 1U);
+
+    CBlockCache::Stats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.max_size, 2U);
+    BOOST_CHECK_EQUAL(stats.hits, 4U);
+    BOOST_CHECK_EQUAL(stats.misses, 2U);
+
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.GetStats().size, 0U);
+    BOOST_CHECK(cache.Get(hash1) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(blockcache_resize)
+{
+    CBlockCache cache(3);
+    for (uint32_t i = 1; i <= 3; ++i) {
+        cache.Insert(ArithToUint256(i), MakeBlock(i));
+    }
+
+    // Shrinking evicts the oldest blocks
+    cache.SetMaxSize(1);
+    BOOST_CHECK_EQUAL(cache.GetStats().size, 1U);
+    BOOST_CHECK(cache.Get(ArithToUint256(1)) == nullptr);
+    BOOST_CHECK(cache.Get(ArithToUint256(2)) == nullptr);
+    BOOST_CHECK_EQUAL(cache.Get(ArithToUint256(3))->nNonce, 3U);
+
+    // A size of 0 disables the cache, lookups are not counted
+    cache.SetMaxSize(0);
+    cache.Insert(ArithToUint256(4), MakeBlock(4));
+    BOOST_CHECK(cache.Get(ArithToUint256(4)) == nullptr);
+    CBlockCache::Stats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.size, 0U);
+    BOOST_CHECK_EQUAL(stats.hits, 1U);
+    BOOST_CHECK_EQUAL(stats.misses, 2U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
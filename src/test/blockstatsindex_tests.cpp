@@ -0,0 +1,106 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <index/blockstatsindex.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <test/test_bitcoin.h>
+#include <undo.h>
+#include <util/system.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(blockstatsindex_tests)
+
+static bool CheckIndexedStats(const BlockStatsIndex& index, const CBlockIndex* pindex)
+{
+    CBlock block;
+    CBlockUndo blockundo;
+    if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) return false;
+    if (pindex->pprev && !UndoReadFromDisk(blockundo, pindex)) return false;
+
+    CBlockStats expected;
+    CBlockStats indexed;
+    if (!ComputeBlockStats(block, blockundo, expected)) return false;
+    if (!index.LookupStats(pindex, indexed)) return false;
+
+    CDataStream ss_expected(SER_DISK, PROTOCOL_VERSION);
+    CDataStream ss_indexed(SER_DISK, PROTOCOL_VERSION);
+    ss_expected << expected;
+    ss_indexed << indexed;
+    return ss_expected.str() == ss_indexed.str();
+}
+
+BOOST_FIXTURE_TEST_CASE(blockstatsindex_initial_sync, TestChain100Setup)
+{
+    BlockStatsIndex index(1 << 20, true);
+
+    CBlockStats stats;
+    const CBlockIndex* tip;
+    {
+        LOCK(cs_main);
+        tip = chainActive.Tip();
+    }
+
+    // Statistics should not be found in the index before it is started.
+    BOOST_CHECK(!index.LookupStats(tip, stats));
+
+    // BlockUntilSyncedToCurrentChain should return false before the index is started.
+    BOOST_CHECK(!index.BlockUntilSyncedToCurrentChain());
+
+    index.Start();
+
+    // Allow the index to catch up with the block index.
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+
+    // Check that the index has all blocks that were in the chain before it started.
+    for (const CBlockIndex* pindex = tip; pindex; pindex = pindex->pprev) {
+        BOOST_CHECK(CheckIndexedStats(index, pindex));
+    }
+
+    // Check that a block spending a coinbase output makes it into the index.
+    CScript coinbase_script_pub_key = GetScriptForDestination(coinbaseKey.GetPubKey().GetID());
+    CMutableTransaction spend;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = COutPoint(m_coinbase_txns[0]->GetHash(), 0);
+    spend.vout.resize(1);
+    spend.vout[0].nValue = m_coinbase_txns[0]->vout[0].nValue - 10000;
+    spend.vout[0].scriptPubKey = coinbase_script_pub_key;
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(m_coinbase_txns[0]->vout[0].scriptPubKey, spend, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+
+    const CBlock block = CreateAndProcessBlock({spend}, coinbase_script_pub_key);
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    {
+        LOCK(cs_main);
+        tip = chainActive.Tip();
+    }
+    BOOST_CHECK_EQUAL(tip->GetBlockHash(), block.GetHash());
+    BOOST_CHECK(index.LookupStats(tip, stats));
+    BOOST_CHECK_EQUAL(stats.txs, 2);
+    BOOST_CHECK_EQUAL(stats.inputs, 1);
+    BOOST_CHECK_EQUAL(stats.totalfee, 10000);
+    BOOST_CHECK(CheckIndexedStats(index, tip));
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    index.Stop();
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
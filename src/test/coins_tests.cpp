@@ -7,6 +7,7 @@
 #include <consensus/validation.h>
 #include <script/standard.h>
 #include <test/test_bitcoin.h>
+#include <txdb.h>
 #include <uint256.h>
 #include <undo.h>
 #include <util/strencodings.h>
@@ -53,7 +54,7 @@ public:
 
     uint256 GetBestBlock() const override { return hashBestBlock_; }
 
-    bool BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock) override
+    bool BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock, const CCoinsSetStats& statsDelta) override
     {
         for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end(); ) {
             if (it->second.flags & CCoinsCacheEntry::DIRTY) {
@@ -589,9 +590,10 @@ void GetCoinsMapEntry(const CCoinsMap& map, CAmount& value, char& flags)
 
 void WriteCoinsViewEntry(CCoinsView& view, CAmount value, char flags)
 {
-    CCoinsMap map;
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map(0, SaltedOutpointHasher(), std::equal_to<COutPoint>(), &resource);
     InsertCoinsMapEntry(map, value, flags);
-    BOOST_CHECK(view.BatchWrite(map, {}));
+    BOOST_CHECK(view.BatchWrite(map, {}, {}));
 }
 
 class SingleEntryCacheTest
@@ -858,4 +860,64 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+static void CheckCoinsSetStats(CCoinsSetStats stats, CCoinsSetStats expected)
+{
+    uint256 hash, expected_hash;
+    stats.muhash.Finalize(hash);
+    expected.muhash.Finalize(expected_hash);
+    BOOST_CHECK(hash == expected_hash);
+    BOOST_CHECK_EQUAL(stats.nTransactionOutputs, expected.nTransactionOutputs);
+    BOOST_CHECK_EQUAL(stats.nBogoSize, expected.nBogoSize);
+    BOOST_CHECK_EQUAL(stats.nTotalAmount, expected.nTotalAmount);
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_stats)
+{
+    CCoinsViewDB base(1 << 20, true);
+    CCoinsSetStats stats;
+    BOOST_CHECK(base.GetStats(stats));
+    CheckCoinsSetStats(stats, CCoinsSetStats());
+
+    COutPoint outpoint_a(InsecureRand256(), 0);
+    COutPoint outpoint_b(InsecureRand256(), 1);
+    const Coin coin_a(CTxOut(50, CScript() << OP_TRUE), 1, false);
+    const Coin coin_b(CTxOut(25, CScript() << OP_TRUE << OP_TRUE), 2, true);
+
+    // Changes of a nested cache are merged into its parent, and then into the database
+    CCoinsViewCache tip(&base);
+    {
+        CCoinsViewCache view(&tip);
+        view.AddCoin(outpoint_a, Coin(coin_a), false);
+        view.AddCoin(outpoint_b, Coin(coin_b), false);
+        view.SetBestBlock(InsecureRand256());
+        BOOST_CHECK(view.Flush());
+    }
+
+    CCoinsSetStats expected;
+    expected.AddCoin(outpoint_b, coin_b);
+    expected.AddCoin(outpoint_a, coin_a);
+
+    BOOST_CHECK(tip.GetStats(stats));
+    CheckCoinsSetStats(stats, expected);
+    BOOST_CHECK(tip.Flush());
+    BOOST_CHECK(base.GetStats(stats));
+    CheckCoinsSetStats(stats, expected);
+    BOOST_CHECK_EQUAL(stats.nTransactionOutputs, 2);
+    BOOST_CHECK_EQUAL(stats.nTotalAmount, 75);
+
+    // Spending a coin removes it from the set
+    BOOST_CHECK(tip.SpendCoin(outpoint_a));
+    tip.SetBestBlock(InsecureRand256());
+    BOOST_CHECK(tip.Flush());
+
+    expected = CCoinsSetStats();
+    expected.AddCoin(outpoint_b, coin_b);
+    BOOST_CHECK(base.GetStats(stats));
+    CheckCoinsSetStats(stats, expected);
+
+    // Statistics can only be stored for the current best block
+    BOOST_CHECK(!base.WriteStats(InsecureRand256(), stats));
+    BOOST_CHECK(base.WriteStats(base.GetBestBlock(), stats));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 
 #include <crypto/aes.h>
 #include <crypto/chacha20.h>
+#include <crypto/muhash.h>
 #include <crypto/ripemd160.h>
 #include <crypto/sha1.h>
 #include <crypto/sha256.h>
@@ -11,6 +12,7 @@
 #include <crypto/hmac_sha256.h>
 #include <crypto/hmac_sha512.h>
 #include <random.h>
+#include <streams.h>
 #include <util/strencodings.h>
 #include <test/test_bitcoin.h>
 
@@ -562,4 +564,71 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+static MuHash3072 FromInt(unsigned char i) {
+    unsigned char tmp[32] = {i, 0};
+    return MuHash3072().Insert(Span<const unsigned char>(tmp, 32));
+}
+
+BOOST_AUTO_TEST_CASE(muhash_tests)
+{
+    uint256 out;
+
+    for (int iter = 0; iter < 10; ++iter) {
+        uint256 res;
+        int table[4];
+        for (int i = 0; i < 4; ++i) {
+            table[i] = InsecureRandBits(3);
+        }
+        for (int order = 0; order < 4; ++order) {
+            MuHash3072 acc;
+            for (int i = 0; i < 4; ++i) {
+                int t = table[i ^ order];
+                if (t & 4) {
+                    acc /= FromInt(t & 3);
+                } else {
+                    acc *= FromInt(t & 3);
+                }
+            }
+            acc.Finalize(out);
+            if (order == 0) {
+                res = out;
+            } else {
+                BOOST_CHECK(res == out);
+            }
+        }
+
+        // Removing an element undoes adding it
+        MuHash3072 x = FromInt(InsecureRandBits(4));
+        MuHash3072 y = FromInt(InsecureRandBits(4));
+        uint256 out2;
+        x.Finalize(out);
+        x *= y;
+        x /= y;
+        x.Finalize(out2);
+        BOOST_CHECK(out == out2);
+    }
+
+    MuHash3072 acc = FromInt(0);
+    acc *= FromInt(1);
+    acc /= FromInt(2);
+    acc.Finalize(out);
+    BOOST_CHECK_EQUAL(out, uint256S("10d312b100cbd32ada024a6646e40d3482fcff103668d2625f10002a607d5863"));
+
+    MuHash3072 empty;
+    empty.Finalize(out);
+    BOOST_CHECK_EQUAL(out, uint256S("dd5ad2a105c2d29495f577245c357409002329b9f4d6182c0af3dc2f462555c8"));
+
+    // Serialization round trip keeps numerator and denominator
+    MuHash3072 ser = FromInt(1);
+    ser /= FromInt(3);
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << ser;
+    MuHash3072 deser;
+    ss >> deser;
+    uint256 out_deser;
+    ser.Finalize(out);
+    deser.Finalize(out_deser);
+    BOOST_CHECK_EQUAL(out, out_deser);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
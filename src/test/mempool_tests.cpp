@@ -749,4 +749,59 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTests)
     BOOST_CHECK_EQUAL(descendants, 6ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolRemoveForBlockTest)
+{
+    size_t ancestors, descendants;
+
+    CTxMemPool pool;
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    // [tx1].0 <- [tx2].0 <- [tx3].0 <- [tx4]
+    // [tx1].1 <------------------------ [tx4]
+    CTransactionRef tx1 = make_tx(/* output_values */ {5 * COIN, 5 * COIN});
+    CTransactionRef tx2 = make_tx(/* output_values */ {4 * COIN}, /* inputs */ {tx1});
+    CTransactionRef tx3 = make_tx(/* output_values */ {3 * COIN}, /* inputs */ {tx2});
+    CTransactionRef tx4 = make_tx(/* output_values */ {7 * COIN}, /* inputs */ {tx3, tx1}, /* input_indices */ {0, 1});
+    pool.addUnchecked(entry.Fee(1000LL).FromTx(tx1));
+    pool.addUnchecked(entry.Fee(2000LL).FromTx(tx2));
+    pool.addUnchecked(entry.Fee(3000LL).FromTx(tx3));
+    pool.addUnchecked(entry.Fee(4000LL).FromTx(tx4));
+
+    // [ty1] <- [ty2], where ty1 is double spent by tz1 in the block
+    CMutableTransaction mty1 = CMutableTransaction(*make_tx(/* output_values */ {COIN}));
+    mty1.vin.resize(1);
+    mty1.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+    CTransactionRef ty1 = MakeTransactionRef(mty1);
+    CTransactionRef ty2 = make_tx(/* output_values */ {COIN}, /* inputs */ {ty1});
+    mty1.vout[0].nValue = 2 * COIN;
+    CTransactionRef tz1 = MakeTransactionRef(mty1);
+    pool.addUnchecked(entry.Fee(1000LL).FromTx(ty1));
+    pool.addUnchecked(entry.Fee(1000LL).FromTx(ty2));
+    BOOST_CHECK_EQUAL(pool.size(), 6U);
+
+    std::vector<CTransactionRef> vtx = {tx1, tx2, tz1};
+    pool.removeForBlock(vtx, 1);
+
+    // Only tx3 and tx4 remain, with the confirmed ancestors subtracted once each
+    BOOST_CHECK_EQUAL(pool.size(), 2U);
+    BOOST_CHECK(pool.exists(tx3->GetHash()));
+    BOOST_CHECK(pool.exists(tx4->GetHash()));
+    pool.GetTransactionAncestry(tx3->GetHash(), ancestors, descendants);
+    BOOST_CHECK_EQUAL(ancestors, 1ULL);
+    BOOST_CHECK_EQUAL(descendants, 2ULL);
+    pool.GetTransactionAncestry(tx4->GetHash(), ancestors, descendants);
+    BOOST_CHECK_EQUAL(ancestors, 2ULL);
+    BOOST_CHECK_EQUAL(descendants, 2ULL);
+
+    CTxMemPool::txiter it3 = pool.mapTx.find(tx3->GetHash());
+    CTxMemPool::txiter it4 = pool.mapTx.find(tx4->GetHash());
+    BOOST_CHECK_EQUAL(it3->GetModFeesWithAncestors(), 3000LL);
+    BOOST_CHECK_EQUAL(it3->GetModFeesWithDescendants(), 7000LL);
+    BOOST_CHECK_EQUAL(it4->GetModFeesWithAncestors(), 7000LL);
+    BOOST_CHECK_EQUAL(it4->GetSizeWithAncestors(), it3->GetTxSize() + it4->GetTxSize());
+    BOOST_CHECK(pool.GetMemPoolParents(it3).empty());
+    BOOST_CHECK_EQUAL(pool.GetMemPoolParents(it4).size(), 1U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+// Copyright (c) 2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coins.h>
+#include <memusage.h>
+#include <support/allocators/pool.h>
+#include <test/test_bitcoin.h>
+
+#include <stdint.h>
+#include <unordered_map>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(pool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(basic_allocating)
+{
+    PoolResource<8, 8> resource(32);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 0U);
+
+    // Blocks are carved out of the chunk, which is allocated on first use
+    void* block = resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+    void* second = resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(static_cast<char*>(second) - static_cast<char*>(block), 8);
+
+    // Freed blocks are reused first
+    resource.Deallocate(block, 8, 8);
+    BOOST_CHECK_EQUAL(resource.Allocate(8, 8), block);
+
+    // Smaller requests are rounded up to the alignment
+    void* small = resource.Allocate(1, 1);
+    BOOST_CHECK_EQUAL(static_cast<char*>(small) - static_cast<char*>(second), 8);
+    resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+
+    // The chunk is full
+    resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+
+    // Larger requests bypass the pool
+    void* large = resource.Allocate(64, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+    resource.Deallocate(large, 64, 8);
+}
+
+BOOST_AUTO_TEST_CASE(remainder_of_chunk_is_reused)
+{
+    PoolResource<16, 8> resource(24);
+    void* first = resource.Allocate(16, 8);
+    // The 8 bytes left in the first chunk are too small, and kept for later
+    resource.Allocate(16, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+    void* rest = resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(static_cast<char*>(rest) - static_cast<char*>(first), 16);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(coins_map_memory_usage)
+{
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map(0, SaltedOutpointHasher(), std::equal_to<COutPoint>(), &resource);
+    // Only the single bucket of the empty map is accounted for
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 0U);
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), memusage::MallocUsage(sizeof(void*) * map.bucket_count()));
+
+    const size_t count = 100000;
+    for (uint32_t i = 0; i < count; ++i) {
+        map[COutPoint(InsecureRand256(), i)];
+    }
+    const size_t usage = memusage::DynamicUsage(map);
+    BOOST_CHECK(usage > 0);
+
+    // The pool saves the malloc overhead of each node
+    const size_t malloc_usage = memusage::MallocUsage(sizeof(memusage::unordered_node<CCoinsMap::value_type>)) * count + memusage::MallocUsage(sizeof(void*) * map.bucket_count());
+    BOOST_CHECK(usage < malloc_usage);
+    BOOST_TEST_MESSAGE("Memory usage of " << count << " coins: " << usage << " bytes pooled, " << malloc_usage << " bytes with malloc");
+
+    // Erased nodes stay in the pool
+    map.clear();
+    BOOST_CHECK(memusage::DynamicUsage(map) >= usage - memusage::MallocUsage(sizeof(void*) * map.bucket_count()));
+}
+
+BOOST_AUTO_TEST_CASE(flush_releases_memory)
+{
+    CCoinsView base;
+    CCoinsViewCache parent(&base);
+    CCoinsViewCache cache(&parent);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        Coin coin;
+        coin.out.nValue = 1;
+        coin.nHeight = 1;
+        cache.AddCoin(COutPoint(InsecureRand256(), i), std::move(coin), false);
+    }
+    const size_t chunk_size = CCoinsMapMemoryResource().ChunkSizeBytes();
+    BOOST_CHECK(cache.DynamicMemoryUsage() > chunk_size);
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    BOOST_CHECK_EQUAL(parent.GetCacheSize(), 1000U);
+    // The chunks of the pool are given back
+    BOOST_CHECK(cache.DynamicMemoryUsage() < chunk_size);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -732,4 +732,60 @@ BOOST_AUTO_TEST_CASE(script_standard_IsMine)
     }
 }
 
+BOOST_AUTO_TEST_CASE(script_standard_IsMineCandidate)
+{
+    CKey keys[3];
+    CPubKey pubkeys[3];
+    for (int i = 0; i < 3; i++) {
+        keys[i].MakeNewKey(i != 2);
+        pubkeys[i] = keys[i].GetPubKey();
+    }
+
+    CBasicKeyStore keystore;
+    BOOST_CHECK(keystore.AddKey(keys[0]));
+    BOOST_CHECK(keystore.AddKey(keys[2]));
+    CScript multisig = GetScriptForMultisig(1, {pubkeys[0], pubkeys[2]});
+    BOOST_CHECK(keystore.AddCScript(multisig));
+    CScript witness_multisig = GetScriptForMultisig(1, {pubkeys[0]});
+    BOOST_CHECK(keystore.AddCScript(witness_multisig));
+    BOOST_CHECK(keystore.AddCScript(GetScriptForDestination(WitnessV0ScriptHash(witness_multisig))));
+    CScript watched = GetScriptForDestination(pubkeys[1].GetID());
+    BOOST_CHECK(keystore.AddWatchOnly(watched));
+
+    std::vector<CScript> scripts;
+    for (const CPubKey& pubkey : pubkeys) {
+        scripts.push_back(GetScriptForRawPubKey(pubkey));
+        scripts.push_back(GetScriptForDestination(pubkey.GetID()));
+        scripts.push_back(GetScriptForDestination(WitnessV0KeyHash(pubkey.GetID())));
+        scripts.push_back(GetScriptForDestination(CScriptID(GetScriptForDestination(WitnessV0KeyHash(pubkey.GetID())))));
+    }
+    for (const CScript& script : {multisig, witness_multisig}) {
+        scripts.push_back(script);
+        scripts.push_back(GetScriptForDestination(CScriptID(script)));
+        scripts.push_back(GetScriptForDestination(WitnessV0ScriptHash(script)));
+        scripts.push_back(GetScriptForDestination(CScriptID(GetScriptForDestination(WitnessV0ScriptHash(script)))));
+    }
+    scripts.push_back(CScript() << OP_9 << OP_ADD << OP_11 << OP_EQUAL);
+
+    // Every script, which is ours, passes the prefilter
+    int mine = 0;
+    for (const CScript& script : scripts) {
+        if (IsMine(keystore, script) != ISMINE_NO) {
+            BOOST_CHECK(keystore.IsMineCandidate(script));
+            ++mine;
+        }
+    }
+    BOOST_CHECK_EQUAL(mine, 11);
+
+    // Scripts of unknown keys are rejected by the prefilter
+    BOOST_CHECK(!keystore.IsMineCandidate(GetScriptForRawPubKey(pubkeys[1])));
+    BOOST_CHECK(!keystore.IsMineCandidate(GetScriptForDestination(WitnessV0KeyHash(pubkeys[1].GetID()))));
+    BOOST_CHECK(!keystore.IsMineCandidate(scripts.back()));
+
+    // Removed watch-only scripts stay candidates, but are no longer ours
+    BOOST_CHECK(keystore.RemoveWatchOnly(watched));
+    BOOST_CHECK(keystore.IsMineCandidate(watched));
+    BOOST_CHECK_EQUAL(IsMine(keystore, watched), ISMINE_NO);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
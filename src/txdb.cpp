@@ -27,6 +27,7 @@ static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_HEAD_BLOCKS = 'H';
+static const char DB_COINS_STATS = 'U';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
@@ -88,7 +89,34 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
     return vhashHeadBlocks;
 }
 
-bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+bool CCoinsViewDB::GetStats(CCoinsSetStats &stats) const {
+    uint256 hashBestChain = GetBestBlock();
+    if (hashBestChain.IsNull()) {
+        // A new database represents the empty set, while a database without
+        // best block, but with head blocks, is only partially written.
+        if (!GetHeadBlocks().empty()) return false;
+        stats = CCoinsSetStats();
+        return true;
+    }
+
+    // The statistics are stored along with the best block they were calculated
+    // for, and are therefore not valid, if they haven't been updated since.
+    std::pair<uint256, CCoinsSetStats> entry;
+    if (!db.Read(DB_COINS_STATS, entry) || entry.first != hashBestChain) {
+        return false;
+    }
+    stats = entry.second;
+    return true;
+}
+
+bool CCoinsViewDB::WriteStats(const uint256 &hashBlock, const CCoinsSetStats &stats) {
+    if (hashBlock.IsNull() || hashBlock != GetBestBlock()) {
+        return false;
+    }
+    return db.Write(DB_COINS_STATS, std::make_pair(hashBlock, stats), true);
+}
+
+bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CCoinsSetStats &statsDelta) {
     CDBBatch batch(db);
     size_t count = 0;
     size_t changed = 0;
@@ -96,6 +124,10 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     int crash_simulate = gArgs.GetArg("-dbcrashratio", 0);
     assert(!hashBlock.IsNull());
 
+    // The statistics can only be maintained, if they are known for the old tip.
+    CCoinsSetStats stats;
+    bool fStats = GetStats(stats);
+
     uint256 old_tip = GetBestBlock();
     if (old_tip.IsNull()) {
         // We may be in the middle of replaying.
@@ -142,6 +174,10 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     // In the last batch, mark the database as consistent with hashBlock again.
     batch.Erase(DB_HEAD_BLOCKS);
     batch.Write(DB_BEST_BLOCK, hashBlock);
+    if (fStats) {
+        stats += statsDelta;
+        batch.Write(DB_COINS_STATS, std::make_pair(hashBlock, stats));
+    }
 
     LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
     bool ret = db.WriteBatch(batch);
@@ -177,12 +213,18 @@ bool CBlockTreeDB::ReadLastBlockFile(int &nFile) {
 }
 
 CCoinsViewCursor *CCoinsViewDB::Cursor() const
+{
+    return Cursor(uint256());
+}
+
+CCoinsViewCursor *CCoinsViewDB::Cursor(const uint256 &hashStart) const
 {
     CCoinsViewDBCursor *i = new CCoinsViewDBCursor(const_cast<CDBWrapper&>(db).NewIterator(), GetBestBlock());
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
        that restriction.  */
-    i->pcursor->Seek(DB_COIN);
+    const COutPoint start(hashStart, 0);
+    i->pcursor->Seek(CoinEntry(&start));
     // Cache key of first record
     if (i->pcursor->Valid()) {
         CoinEntry entry(&i->keyTmp.second);
@@ -44,6 +44,8 @@ static const int64_t nMaxBlockDBCache = 2;
 // Unlike for the UTXO database, for the txindex scenario the leveldb cache make
 // a meaningful difference: https://github.com/bitcoin/bitcoin/pull/8273#issuecomment-229601991
 static const int64_t nMaxTxIndexCache = 1024;
+//! Max memory allocated to block statistics index DB specific cache (MiB)
+static const int64_t nMaxBlockStatsIndexCache = 16;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
 
@@ -59,8 +61,14 @@ public:
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     std::vector<uint256> GetHeadBlocks() const override;
-    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    bool GetStats(CCoinsSetStats &stats) const override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, const CCoinsSetStats &statsDelta) override;
     CCoinsViewCursor *Cursor() const override;
+    //! Get a cursor positioned at the first coin with a txid not smaller than hashStart (in key order).
+    CCoinsViewCursor *Cursor(const uint256 &hashStart) const;
+
+    //! Store the statistics of the coins set, calculated for the given best block.
+    bool WriteStats(const uint256 &hashBlock, const CCoinsSetStats &stats);
 
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
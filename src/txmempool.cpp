@@ -23,7 +23,7 @@ CTxMemPoolEntry::CTxMemPoolEntry(const CTransactionRef& _tx, const CAmount& _nFe
                                  int64_t _nTime, unsigned int _entryHeight,
                                  bool _spendsCoinbase, int64_t _sigOpsCost, LockPoints lp)
     : tx(_tx), nFee(_nFee), nTxWeight(GetTransactionWeight(*tx)), nUsageSize(RecursiveDynamicUsage(tx)), nTime(_nTime), entryHeight(_entryHeight),
-    spendsCoinbase(_spendsCoinbase), sigOpCost(_sigOpsCost), lockPoints(lp)
+    spendsCoinbase(_spendsCoinbase), sigOpCost(_sigOpsCost), lockPoints(lp), m_epoch(0)
 {
     nCountWithDescendants = 1;
     nSizeWithDescendants = GetTxSize();
@@ -59,39 +59,47 @@ size_t CTxMemPoolEntry::GetTxSize() const
 // descendants.
 void CTxMemPool::UpdateForDescendants(txiter updateIt, cacheMap &cachedDescendants, const std::set<uint256> &setExclude)
 {
-    setEntries stageEntries, setAllDescendants;
-    stageEntries = GetMemPoolChildren(updateIt);
-
-    while (!stageEntries.empty()) {
-        const txiter cit = *stageEntries.begin();
-        setAllDescendants.insert(cit);
-        stageEntries.erase(cit);
-        const setEntries &setChildren = GetMemPoolChildren(cit);
-        for (txiter childEntry : setChildren) {
-            cacheMap::iterator cacheIt = cachedDescendants.find(childEntry);
-            if (cacheIt != cachedDescendants.end()) {
-                // We've already calculated this one, just add the entries for this set
-                // but don't traverse again.
-                for (txiter cacheEntry : cacheIt->second) {
-                    setAllDescendants.insert(cacheEntry);
+    std::vector<txiter> stageEntries, allDescendants;
+    {
+        const auto epoch = GetFreshEpoch();
+        for (txiter childEntry : GetMemPoolChildren(updateIt)) {
+            visited(childEntry);
+            stageEntries.push_back(childEntry);
+        }
+
+        while (!stageEntries.empty()) {
+            const txiter cit = stageEntries.back();
+            stageEntries.pop_back();
+            allDescendants.push_back(cit);
+            const setEntries &setChildren = GetMemPoolChildren(cit);
+            for (txiter childEntry : setChildren) {
+                cacheMap::iterator cacheIt = cachedDescendants.find(childEntry);
+                if (cacheIt != cachedDescendants.end()) {
+                    // We've already calculated this one, just add the entries for this set
+                    // but don't traverse again.
+                    for (txiter cacheEntry : cacheIt->second) {
+                        if (!visited(cacheEntry)) {
+                            allDescendants.push_back(cacheEntry);
+                        }
+                    }
+                } else if (!visited(childEntry)) {
+                    // Schedule for later processing
+                    stageEntries.push_back(childEntry);
                 }
-            } else if (!setAllDescendants.count(childEntry)) {
-                // Schedule for later processing
-                stageEntries.insert(childEntry);
             }
         }
     }
-    // setAllDescendants now contains all in-mempool descendants of updateIt.
+    // allDescendants now contains all in-mempool descendants of updateIt.
     // Update and add to cached descendant map
     int64_t modifySize = 0;
     CAmount modifyFee = 0;
     int64_t modifyCount = 0;
-    for (txiter cit : setAllDescendants) {
+    for (txiter cit : allDescendants) {
         if (!setExclude.count(cit->GetTx().GetHash())) {
             modifySize += cit->GetTxSize();
             modifyFee += cit->GetModifiedFee();
             modifyCount++;
-            cachedDescendants[updateIt].insert(cit);
+            cachedDescendants[updateIt].push_back(cit);
             // Update ancestor state for each descendant
             mapTx.modify(cit, update_ancestor_state(updateIt->GetTxSize(), updateIt->GetModifiedFee(), 1, updateIt->GetSigOpCost()));
         }
@@ -149,7 +157,10 @@ void CTxMemPool::UpdateTransactionsFromBlock(const std::vector<uint256> &vHashes
 
 bool CTxMemPool::CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntries &setAncestors, uint64_t limitAncestorCount, uint64_t limitAncestorSize, uint64_t limitDescendantCount, uint64_t limitDescendantSize, std::string &errString, bool fSearchForParents /* = true */) const
 {
-    setEntries parentHashes;
+    // Entries are marked as visited when they are staged, so that every
+    // ancestor is staged (and counted) exactly once.
+    const auto epoch = GetFreshEpoch();
+    std::vector<txiter> parentHashes;
     const CTransaction &tx = entry.GetTx();
 
     if (fSearchForParents) {
@@ -158,8 +169,8 @@ bool CTxMemPool::CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntr
         // iterate mapTx to find parents.
         for (unsigned int i = 0; i < tx.vin.size(); i++) {
             boost::optional<txiter> piter = GetIter(tx.vin[i].prevout.hash);
-            if (piter) {
-                parentHashes.insert(*piter);
+            if (piter && !visited(*piter)) {
+                parentHashes.push_back(*piter);
                 if (parentHashes.size() + 1 > limitAncestorCount) {
                     errString = strprintf("too many unconfirmed parents [limit: %u]", limitAncestorCount);
                     return false;
@@ -170,16 +181,19 @@ bool CTxMemPool::CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntr
         // If we're not searching for parents, we require this to be an
         // entry in the mempool already.
         txiter it = mapTx.iterator_to(entry);
-        parentHashes = GetMemPoolParents(it);
+        for (txiter piter : GetMemPoolParents(it)) {
+            visited(piter);
+            parentHashes.push_back(piter);
+        }
     }
 
     size_t totalSizeWithAncestors = entry.GetTxSize();
 
     while (!parentHashes.empty()) {
-        txiter stageit = *parentHashes.begin();
+        txiter stageit = parentHashes.back();
 
         setAncestors.insert(stageit);
-        parentHashes.erase(stageit);
+        parentHashes.pop_back();
         totalSizeWithAncestors += stageit->GetTxSize();
 
         if (stageit->GetSizeWithDescendants() + entry.GetTxSize() > limitDescendantSize) {
@@ -196,8 +210,8 @@ bool CTxMemPool::CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntr
         const setEntries & setMemPoolParents = GetMemPoolParents(stageit);
         for (txiter phash : setMemPoolParents) {
             // If this is a new ancestor, add it.
-            if (setAncestors.count(phash) == 0) {
-                parentHashes.insert(phash);
+            if (!visited(phash)) {
+                parentHashes.push_back(phash);
             }
             if (parentHashes.size() + setAncestors.size() + 1 > limitAncestorCount) {
                 errString = strprintf("too many unconfirmed ancestors [limit: %u]", limitAncestorCount);
@@ -258,43 +272,79 @@ void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, b
         // Here we only update statistics and not data in mapLinks (which
         // we need to preserve until we're finished with all operations that
         // need to traverse the mempool).
-        for (txiter removeIt : entriesToRemove) {
-            setEntries setDescendants;
-            CalculateDescendants(removeIt, setDescendants);
-            setDescendants.erase(removeIt); // don't update state for self
-            int64_t modifySize = -((int64_t)removeIt->GetTxSize());
-            CAmount modifyFee = -removeIt->GetModifiedFee();
-            int modifySigOps = -removeIt->GetSigOpCost();
-            for (txiter dit : setDescendants) {
-                mapTx.modify(dit, update_ancestor_state(modifySize, modifyFee, -1, modifySigOps));
+        // Only descendants that stay in the mempool need their ancestor state
+        // updated. Each of them is visited once and adjusted by the sum of its
+        // ancestors being removed, instead of once per removed ancestor.
+        std::vector<txiter> descendants;
+        {
+            const auto epoch = GetFreshEpoch();
+            for (txiter removeIt : entriesToRemove) {
+                for (txiter childIt : GetMemPoolChildren(removeIt)) {
+                    if (!entriesToRemove.count(childIt)) {
+                        CalculateDescendantsInEpoch(childIt, descendants);
+                    }
+                }
             }
         }
+        for (txiter dit : descendants) {
+            setEntries setAncestors;
+            std::string dummy;
+            CalculateMemPoolAncestors(*dit, setAncestors, nNoLimit, nNoLimit, nNoLimit, nNoLimit, dummy, false);
+            int64_t modifySize = 0;
+            CAmount modifyFee = 0;
+            int64_t modifyCount = 0;
+            int64_t modifySigOps = 0;
+            for (txiter ancestorIt : setAncestors) {
+                if (entriesToRemove.count(ancestorIt)) {
+                    modifySize -= (int64_t)ancestorIt->GetTxSize();
+                    modifyFee -= ancestorIt->GetModifiedFee();
+                    modifyCount--;
+                    modifySigOps -= ancestorIt->GetSigOpCost();
+                }
+            }
+            mapTx.modify(dit, update_ancestor_state(modifySize, modifyFee, modifyCount, modifySigOps));
+        }
     }
+    // If every in-mempool parent of the entries being removed is itself being
+    // removed (as is the case for the transactions of a connected block), no
+    // ancestor remains whose descendant state or child links need updating.
+    bool fAncestorsRemoved = true;
     for (txiter removeIt : entriesToRemove) {
-        setEntries setAncestors;
-        const CTxMemPoolEntry &entry = *removeIt;
-        std::string dummy;
-        // Since this is a tx that is already in the mempool, we can call CMPA
-        // with fSearchForParents = false.  If the mempool is in a consistent
-        // state, then using true or false should both be correct, though false
-        // should be a bit faster.
-        // However, if we happen to be in the middle of processing a reorg, then
-        // the mempool can be in an inconsistent state.  In this case, the set
-        // of ancestors reachable via mapLinks will be the same as the set of
-        // ancestors whose packages include this transaction, because when we
-        // add a new transaction to the mempool in addUnchecked(), we assume it
-        // has no children, and in the case of a reorg where that assumption is
-        // false, the in-mempool children aren't linked to the in-block tx's
-        // until UpdateTransactionsFromBlock() is called.
-        // So if we're being called during a reorg, ie before
-        // UpdateTransactionsFromBlock() has been called, then mapLinks[] will
-        // differ from the set of mempool parents we'd calculate by searching,
-        // and it's important that we use the mapLinks[] notion of ancestor
-        // transactions as the set of things to update for removal.
-        CalculateMemPoolAncestors(entry, setAncestors, nNoLimit, nNoLimit, nNoLimit, nNoLimit, dummy, false);
-        // Note that UpdateAncestorsOf severs the child links that point to
-        // removeIt in the entries for the parents of removeIt.
-        UpdateAncestorsOf(false, removeIt, setAncestors);
+        for (txiter parentIt : GetMemPoolParents(removeIt)) {
+            if (!entriesToRemove.count(parentIt)) {
+                fAncestorsRemoved = false;
+                break;
+            }
+        }
+        if (!fAncestorsRemoved) break;
+    }
+    if (!fAncestorsRemoved) {
+        for (txiter removeIt : entriesToRemove) {
+            setEntries setAncestors;
+            const CTxMemPoolEntry &entry = *removeIt;
+            std::string dummy;
+            // Since this is a tx that is already in the mempool, we can call CMPA
+            // with fSearchForParents = false.  If the mempool is in a consistent
+            // state, then using true or false should both be correct, though false
+            // should be a bit faster.
+            // However, if we happen to be in the middle of processing a reorg, then
+            // the mempool can be in an inconsistent state.  In this case, the set
+            // of ancestors reachable via mapLinks will be the same as the set of
+            // ancestors whose packages include this transaction, because when we
+            // add a new transaction to the mempool in addUnchecked(), we assume it
+            // has no children, and in the case of a reorg where that assumption is
+            // false, the in-mempool children aren't linked to the in-block tx's
+            // until UpdateTransactionsFromBlock() is called.
+            // So if we're being called during a reorg, ie before
+            // UpdateTransactionsFromBlock() has been called, then mapLinks[] will
+            // differ from the set of mempool parents we'd calculate by searching,
+            // and it's important that we use the mapLinks[] notion of ancestor
+            // transactions as the set of things to update for removal.
+            CalculateMemPoolAncestors(entry, setAncestors, nNoLimit, nNoLimit, nNoLimit, nNoLimit, dummy, false);
+            // Note that UpdateAncestorsOf severs the child links that point to
+            // removeIt in the entries for the parents of removeIt.
+            UpdateAncestorsOf(false, removeIt, setAncestors);
+        }
     }
     // After updating all the ancestor sizes, we can now sever the link between each
     // transaction being removed and any mempool children (ie, update setMemPoolParents
@@ -325,7 +375,7 @@ void CTxMemPoolEntry::UpdateAncestorState(int64_t modifySize, CAmount modifyFee,
 }
 
 CTxMemPool::CTxMemPool(CBlockPolicyEstimator* estimator) :
-    nTransactionsUpdated(0), minerPolicyEstimator(estimator)
+    nTransactionsUpdated(0), minerPolicyEstimator(estimator), m_epoch(0), m_has_epoch_guard(false)
 {
     _clear(); //lock free clear
 
@@ -437,22 +487,44 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 // can save time by not iterating over those entries.
 void CTxMemPool::CalculateDescendants(txiter entryit, setEntries& setDescendants) const
 {
-    setEntries stage;
-    if (setDescendants.count(entryit) == 0) {
-        stage.insert(entryit);
+    if (setDescendants.count(entryit) != 0) {
+        return;
     }
+    const auto epoch = GetFreshEpoch();
+    std::vector<txiter> stage;
+    visited(entryit);
+    stage.push_back(entryit);
     // Traverse down the children of entry, only adding children that are not
     // accounted for in setDescendants already (because those children have either
     // already been walked, or will be walked in this iteration).
     while (!stage.empty()) {
-        txiter it = *stage.begin();
+        txiter it = stage.back();
         setDescendants.insert(it);
-        stage.erase(it);
+        stage.pop_back();
 
         const setEntries &setChildren = GetMemPoolChildren(it);
         for (txiter childiter : setChildren) {
-            if (!setDescendants.count(childiter)) {
-                stage.insert(childiter);
+            if (!visited(childiter) && !setDescendants.count(childiter)) {
+                stage.push_back(childiter);
+            }
+        }
+    }
+}
+
+void CTxMemPool::CalculateDescendantsInEpoch(txiter entryit, std::vector<txiter>& descendants) const
+{
+    if (visited(entryit)) {
+        return;
+    }
+    // Entries are appended to descendants when they are first visited, the
+    // part of descendants not walked yet serves as the stage.
+    size_t next = descendants.size();
+    descendants.push_back(entryit);
+    while (next < descendants.size()) {
+        const setEntries &setChildren = GetMemPoolChildren(descendants[next++]);
+        for (txiter childiter : setChildren) {
+            if (!visited(childiter)) {
+                descendants.push_back(childiter);
             }
         }
     }
@@ -481,11 +553,15 @@ void CTxMemPool::removeRecursive(const CTransaction &origTx, MemPoolRemovalReaso
                 txToRemove.insert(nextit);
             }
         }
-        setEntries setAllRemoves;
-        for (txiter it : txToRemove) {
-            CalculateDescendants(it, setAllRemoves);
+        std::vector<txiter> allRemoves;
+        {
+            const auto epoch = GetFreshEpoch();
+            for (txiter it : txToRemove) {
+                CalculateDescendantsInEpoch(it, allRemoves);
+            }
         }
 
+        setEntries setAllRemoves(allRemoves.begin(), allRemoves.end());
         RemoveStaged(setAllRemoves, false, reason);
     }
 }
@@ -546,30 +622,53 @@ void CTxMemPool::removeConflicts(const CTransaction &tx)
 
 /**
  * Called when a block is connected. Removes from mempool and updates the miner fee estimator.
+ *
+ * The transactions of the block are removed as a single batch, so that
+ * ancestor/descendant state and links are updated once for all of them,
+ * rather than once per block transaction. Conflicts are then collected for
+ * the whole block and removed together with their descendants.
  */
 void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigned int nBlockHeight)
 {
     LOCK(cs);
     std::vector<const CTxMemPoolEntry*> entries;
+    setEntries stage;
     for (const auto& tx : vtx)
     {
         uint256 hash = tx->GetHash();
 
         indexed_transaction_set::iterator i = mapTx.find(hash);
-        if (i != mapTx.end())
+        if (i != mapTx.end()) {
             entries.push_back(&*i);
+            stage.insert(i);
+        }
     }
     // Before the txs in the new block have been removed from the mempool, update policy estimates
     if (minerPolicyEstimator) {minerPolicyEstimator->processBlock(nBlockHeight, entries);}
-    for (const auto& tx : vtx)
+    RemoveStaged(stage, true, MemPoolRemovalReason::BLOCK);
+
+    // With the block transactions gone, any remaining spender of one of their
+    // inputs conflicts with the block and is removed along with its descendants.
+    std::vector<txiter> conflicts;
     {
-        txiter it = mapTx.find(tx->GetHash());
-        if (it != mapTx.end()) {
-            setEntries stage;
-            stage.insert(it);
-            RemoveStaged(stage, true, MemPoolRemovalReason::BLOCK);
+        const auto epoch = GetFreshEpoch();
+        for (const auto& tx : vtx) {
+            for (const CTxIn &txin : tx->vin) {
+                auto it = mapNextTx.find(txin.prevout);
+                if (it != mapNextTx.end()) {
+                    txiter conflictIt = mapTx.find(it->second->GetHash());
+                    assert(conflictIt != mapTx.end());
+                    ClearPrioritisation(conflictIt->GetTx().GetHash());
+                    CalculateDescendantsInEpoch(conflictIt, conflicts);
+                }
+            }
         }
-        removeConflicts(*tx);
+    }
+    setEntries setConflicts(conflicts.begin(), conflicts.end());
+    RemoveStaged(setConflicts, false, MemPoolRemovalReason::CONFLICT);
+
+    for (const auto& tx : vtx)
+    {
         ClearPrioritisation(tx->GetHash());
         removeAddressIndex(tx->GetHash());
         removeSpentIndex(tx->GetHash());
@@ -1250,3 +1349,22 @@ bool CTxMemPool::removeSpentIndex(const uint256 txhash)
 
     return true;
 }
+
+CTxMemPool::EpochGuard CTxMemPool::GetFreshEpoch() const
+{
+    return EpochGuard(*this);
+}
+
+CTxMemPool::EpochGuard::EpochGuard(const CTxMemPool& in) : pool(in)
+{
+    assert(!pool.m_has_epoch_guard);
+    ++pool.m_epoch;
+    pool.m_has_epoch_guard = true;
+}
+
+CTxMemPool::EpochGuard::~EpochGuard()
+{
+    // Entries visited in this epoch are not considered visited in the next one
+    ++pool.m_epoch;
+    pool.m_has_epoch_guard = false;
+}
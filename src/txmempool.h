@@ -6,6 +6,7 @@
 #ifndef BITCOIN_TXMEMPOOL_H
 #define BITCOIN_TXMEMPOOL_H
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <map>
@@ -212,6 +213,7 @@ public:
     int64_t GetSigOpCostWithAncestors() const { return nSigOpCostWithAncestors; }
 
     mutable size_t vTxHashesIdx; //!< Index in mempool's vTxHashes
+    mutable uint64_t m_epoch; //!< Epoch in which the entry was last visited by a graph traversal, see CTxMemPool::visited()
 };
 
 // Helpers for modifying CTxMemPool::mapTx, which is a boost multi_index.
@@ -535,6 +537,9 @@ private:
     mutable bool blockSinceLastRollingFeeBump;
     mutable double rollingMinimumFeeRate; //!< minimum fee to get into the pool, decreases exponentially
 
+    mutable uint64_t m_epoch;          //!< Current traversal epoch, see GetFreshEpoch()
+    mutable bool m_has_epoch_guard;    //!< Whether an EpochGuard is alive
+
     void trackPackageRemoved(const CFeeRate& rate) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
 public:
@@ -620,7 +625,7 @@ public:
     const setEntries & GetMemPoolChildren(txiter entry) const EXCLUSIVE_LOCKS_REQUIRED(cs);
     uint64_t CalculateDescendantMaximum(txiter entry) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 private:
-    typedef std::map<txiter, setEntries, CompareIteratorByHash> cacheMap;
+    typedef std::map<txiter, std::vector<txiter>, CompareIteratorByHash> cacheMap;
 
     struct TxLinks {
         setEntries parents;
@@ -752,6 +757,39 @@ public:
      *  already in it.  */
     void CalculateDescendants(txiter it, setEntries& setDescendants) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** Append it and all of its in-mempool descendants, which were not visited
+     *  in the current epoch yet, to descendants. The caller must hold an epoch,
+     *  see GetFreshEpoch(). */
+    void CalculateDescendantsInEpoch(txiter it, std::vector<txiter>& descendants) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /**
+     * RAII guard of a graph traversal epoch.
+     *
+     * Instead of collecting the entries seen during a walk over ancestors or
+     * descendants in a temporary std::set, which allocates a node and costs
+     * O(log n) per entry, every entry carries the epoch it was last visited in.
+     * Starting a new epoch invalidates all marks at once. Only one epoch may
+     * be held at a time, so traversals using it must not be nested.
+     */
+    class EpochGuard {
+        const CTxMemPool& pool;
+    public:
+        explicit EpochGuard(const CTxMemPool& in);
+        ~EpochGuard();
+    };
+
+    /** Start a new traversal epoch, which lasts as long as the returned guard. */
+    EpochGuard GetFreshEpoch() const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /** Mark the entry as visited in the current epoch and return whether it already was. */
+    bool visited(txiter it) const EXCLUSIVE_LOCKS_REQUIRED(cs)
+    {
+        assert(m_has_epoch_guard);
+        bool ret = it->m_epoch >= m_epoch;
+        it->m_epoch = std::max(it->m_epoch, m_epoch);
+        return ret;
+    }
+
     /** The minimum fee to get into the mempool, which may itself not be enough
       *  for larger-sized transactions.
       *  The incrementalRelayFee policy variable is used to bound the time it
@@ -687,6 +687,8 @@ void PrintExceptionContinue(const std::exception* pex, const char* pszThread)
 {
     std::string message = FormatException(pex, pszThread);
     LogPrintf("\n\n************************\n%s\n", message);
+    // The thread may be about to take the process down, so don't leave the message in the log queue
+    LogInstance().Flush();
     tfm::format(std::cerr, "\n\n************************\n%s\n", message.c_str());
 }
 
@@ -6,6 +6,7 @@
 #include <validation.h>
 
 #include <arith_uint256.h>
+#include <blockcache.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -45,6 +46,7 @@
 
 #include <future>
 #include <sstream>
+#include <thread>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/thread.hpp>
@@ -155,6 +157,8 @@ private:
 public:
     CChain chainActive;
     BlockMap mapBlockIndex GUARDED_BY(cs_main);
+    /** Entries of mapBlockIndex, which no other entry builds on. Used by getchaintips. */
+    std::set<CBlockIndex*> setBlockIndexLeaves GUARDED_BY(cs_main);
     std::multimap<CBlockIndex*, CBlockIndex*> mapBlocksUnlinked;
     CBlockIndex *pindexBestInvalid = nullptr;
 
@@ -165,8 +169,9 @@ public:
     /**
      * If a block header hasn't already been seen, call CheckBlockHeader on it, ensure
      * that it doesn't descend from an invalid block, and then add it to mapBlockIndex.
+     * fCheckHeader may be set to false if CheckBlockHeader already passed for this header.
      */
-    bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fCheckHeader = true) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fRequested, const CDiskBlockPos* dbp, bool* fNewBlock) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     // Block (dis)connection on a given view:
@@ -228,6 +233,7 @@ private:
 RecursiveMutex cs_main;
 
 BlockMap& mapBlockIndex = g_chainstate.mapBlockIndex;
+std::set<CBlockIndex*>& setBlockIndexLeaves = g_chainstate.setBlockIndexLeaves;
 CChain& chainActive = g_chainstate.chainActive;
 CBlockIndex *pindexBestHeader = nullptr;
 Mutex g_best_block_mutex;
@@ -286,6 +292,10 @@ namespace {
 
     /** Dirty block file entries. */
     std::set<int> setDirtyFileInfo;
+
+    /** Block index entries by the block file their data was stored in, so a file can be pruned
+     *  without walking mapBlockIndex. Entries may be stale if their data was erased since. */
+    std::vector<std::vector<CBlockIndex*>> vBlocksInFile;
 } // anon namespace
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1121,6 +1131,12 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
 
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
+    std::shared_ptr<const CBlock> cached_block = g_block_cache.Get(pindex->GetBlockHash());
+    if (cached_block) {
+        block = *cached_block;
+        return true;
+    }
+
     CDiskBlockPos blockPos;
     {
         LOCK(cs_main);
@@ -1525,7 +1541,9 @@ bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint
     return true;
 }
 
-static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
+} // namespace
+
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
 {
     CDiskBlockPos pos = pindex->GetUndoPos();
     if (pos.IsNull()) {
@@ -1556,6 +1574,8 @@ static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
     return true;
 }
 
+namespace {
+
 static bool AbortNode(CValidationState& state, const std::string& strMessage, const std::string& userMessage="")
 {
     ::AbortNode(strMessage, userMessage);
@@ -2599,6 +2619,7 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     LogPrint(BCLog::HANDLER, "Omni Core handler: block connect end [new height: %d, found: %u txs]\n", pindexNew->nHeight, nNumMetaTxs);
     mastercore_handler_block_end(pindexNew->nHeight, pindexNew, nNumMetaTxs);
 
+    g_block_cache.Insert(pindexNew->GetBlockHash(), pthisBlock);
     connectTrace.BlockConnected(pindexNew, std::move(pthisBlock));
     return true;
 }
@@ -3004,13 +3025,17 @@ bool CChainState::InvalidateBlock(CValidationState& state, const CChainParams& c
         m_failed_blocks.insert(to_mark_failed);
 
         // The resulting new best tip may not be in setBlockIndexCandidates anymore, so
-        // add it again.
-        BlockMap::iterator it = mapBlockIndex.begin();
-        while (it != mapBlockIndex.end()) {
-            if (it->second->IsValid(BLOCK_VALID_TRANSACTIONS) && it->second->HaveTxsDownloaded() && !setBlockIndexCandidates.value_comp()(it->second, chainActive.Tip())) {
-                setBlockIndexCandidates.insert(it->second);
+        // add it again. Only blocks with at least as much work as the tip qualify, and
+        // chain work never decreases towards the leaves, so walk back from each leaf
+        // until the work drops below the tip's, or a block was already visited.
+        std::set<CBlockIndex*> setVisited;
+        for (CBlockIndex* pindexLeaf : setBlockIndexLeaves) {
+            for (CBlockIndex* pindexWalk = pindexLeaf; pindexWalk != nullptr && pindexWalk->nChainWork >= chainActive.Tip()->nChainWork; pindexWalk = pindexWalk->pprev) {
+                if (!setVisited.insert(pindexWalk).second) break;
+                if (pindexWalk->IsValid(BLOCK_VALID_TRANSACTIONS) && pindexWalk->HaveTxsDownloaded() && !setBlockIndexCandidates.value_comp()(pindexWalk, chainActive.Tip())) {
+                    setBlockIndexCandidates.insert(pindexWalk);
+                }
             }
-            it++;
         }
 
         InvalidChainFound(to_mark_failed);
@@ -3032,26 +3057,33 @@ void CChainState::ResetBlockFailureFlags(CBlockIndex *pindex) {
 
     int nHeight = pindex->nHeight;
 
+    // Collect this block and all its descendants, by walking back from the
+    // leaves it is an ancestor of.
+    std::set<CBlockIndex*> setDescendants{pindex};
+    for (CBlockIndex* pindexLeaf : setBlockIndexLeaves) {
+        if (pindexLeaf->nHeight <= nHeight || pindexLeaf->GetAncestor(nHeight) != pindex) continue;
+        for (CBlockIndex* pindexWalk = pindexLeaf; setDescendants.insert(pindexWalk).second; pindexWalk = pindexWalk->pprev) {}
+    }
+
     // Remove the invalidity flag from this block and all its descendants.
-    BlockMap::iterator it = mapBlockIndex.begin();
-    while (it != mapBlockIndex.end()) {
-        if (!it->second->IsValid() && it->second->GetAncestor(nHeight) == pindex) {
-            it->second->nStatus &= ~BLOCK_FAILED_MASK;
-            setDirtyBlockIndex.insert(it->second);
-            if (it->second->IsValid(BLOCK_VALID_TRANSACTIONS) && it->second->HaveTxsDownloaded() && setBlockIndexCandidates.value_comp()(chainActive.Tip(), it->second)) {
-                setBlockIndexCandidates.insert(it->second);
+    for (CBlockIndex* pindexDescendant : setDescendants) {
+        if (!pindexDescendant->IsValid()) {
+            pindexDescendant->nStatus &= ~BLOCK_FAILED_MASK;
+            setDirtyBlockIndex.insert(pindexDescendant);
+            if (pindexDescendant->IsValid(BLOCK_VALID_TRANSACTIONS) && pindexDescendant->HaveTxsDownloaded() && setBlockIndexCandidates.value_comp()(chainActive.Tip(), pindexDescendant)) {
+                setBlockIndexCandidates.insert(pindexDescendant);
             }
-            if (it->second == pindexBestInvalid) {
+            if (pindexDescendant == pindexBestInvalid) {
                 // Reset invalid block marker if it was pointing to one of those.
                 pindexBestInvalid = nullptr;
             }
-            m_failed_blocks.erase(it->second);
+            m_failed_blocks.erase(pindexDescendant);
         }
-        it++;
     }
 
-    // Remove the invalidity flag from all ancestors too.
-    while (pindex != nullptr) {
+    // Remove the invalidity flag from all ancestors too. Blocks in the active
+    // chain are never marked invalid, so stop at the first one.
+    while (pindex != nullptr && !chainActive.Contains(pindex)) {
         if (pindex->nStatus & BLOCK_FAILED_MASK) {
             pindex->nStatus &= ~BLOCK_FAILED_MASK;
             setDirtyBlockIndex.insert(pindex);
@@ -3089,7 +3121,9 @@ CBlockIndex* CChainState::AddToBlockIndex(const CBlockHeader& block)
         pindexNew->pprev = (*miPrev).second;
         pindexNew->nHeight = pindexNew->pprev->nHeight + 1;
         pindexNew->BuildSkip();
+        setBlockIndexLeaves.erase(pindexNew->pprev);
     }
+    setBlockIndexLeaves.insert(pindexNew);
     pindexNew->nTimeMax = (pindexNew->pprev ? std::max(pindexNew->pprev->nTimeMax, pindexNew->nTime) : pindexNew->nTime);
     pindexNew->nChainWork = (pindexNew->pprev ? pindexNew->pprev->nChainWork : 0) + GetBlockProof(*pindexNew);
     pindexNew->RaiseValidity(BLOCK_VALID_TREE);
@@ -3110,6 +3144,10 @@ void CChainState::ReceivedBlockTransactions(const CBlock& block, CBlockIndex* pi
     pindexNew->nDataPos = pos.nPos;
     pindexNew->nUndoPos = 0;
     pindexNew->nStatus |= BLOCK_HAVE_DATA;
+    if (vBlocksInFile.size() <= (unsigned int)pos.nFile) {
+        vBlocksInFile.resize(pos.nFile + 1);
+    }
+    vBlocksInFile[pos.nFile].push_back(pindexNew);
     if (IsWitnessEnabled(pindexNew->pprev, consensusParams)) {
         pindexNew->nStatus |= BLOCK_OPT_WITNESS;
     }
@@ -3249,6 +3287,52 @@ static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state,
     return true;
 }
 
+/** Maximum number of threads used to check the headers of a single headers message. */
+static const int MAX_HEADERS_CHECK_THREADS = 8;
+/** Minimum number of headers per thread when checking them in parallel. */
+static const size_t MIN_HEADERS_PER_CHECK_THREAD = 100;
+
+/**
+ * Call CheckBlockHeader on each of the headers from nBegin on (except the
+ * genesis block) and return the index of the first one that fails, or
+ * headers.size() if all pass. The state of the failing header is returned in
+ * state. Hashing the headers for their proof of work dominates header sync,
+ * so large batches are split over several threads.
+ */
+static size_t CheckBlockHeaders(const std::vector<CBlockHeader>& headers, size_t nBegin, CValidationState& state, const Consensus::Params& consensusParams)
+{
+    const size_t nCount = headers.size() - nBegin;
+    const size_t nThreads = std::max<size_t>(1, std::min<size_t>({(size_t)GetNumCores(), (size_t)MAX_HEADERS_CHECK_THREADS, nCount / MIN_HEADERS_PER_CHECK_THREAD}));
+    std::vector<size_t> vFirstInvalid(nThreads, headers.size());
+    std::vector<CValidationState> vState(nThreads);
+    auto check = [&](size_t nThread) {
+        const size_t nEnd = nBegin + nCount * (nThread + 1) / nThreads;
+        for (size_t i = nBegin + nCount * nThread / nThreads; i < nEnd; ++i) {
+            if (headers[i].GetHash() != consensusParams.hashGenesisBlock && !CheckBlockHeader(headers[i], vState[nThread], consensusParams)) {
+                vFirstInvalid[nThread] = i;
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t nThread = 1; nThread < nThreads; ++nThread) {
+        threads.emplace_back(check, nThread);
+    }
+    check(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t nThread = 0; nThread < nThreads; ++nThread) {
+        if (vFirstInvalid[nThread] < headers.size()) {
+            state = vState[nThread];
+            return vFirstInvalid[nThread];
+        }
+    }
+    return headers.size();
+}
+
 bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot)
 {
     // These are checks that are independent of context.
@@ -3534,7 +3618,7 @@ static bool ContextualCheckBlock(const CBlock& block, CValidationState& state, c
     return true;
 }
 
-bool CChainState::AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
+bool CChainState::AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fCheckHeader)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
@@ -3552,7 +3636,7 @@ bool CChainState::AcceptBlockHeader(const CBlockHeader& block, CValidationState&
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus()))
+        if (fCheckHeader && !CheckBlockHeader(block, state, chainparams.GetConsensus()))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
 
         // Get prev block index
@@ -3619,18 +3703,44 @@ bool CChainState::AcceptBlockHeader(const CBlockHeader& block, CValidationState&
 bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex, CBlockHeader *first_invalid)
 {
     if (first_invalid != nullptr) first_invalid->SetNull();
+
+    // Headers, which are in mapBlockIndex already, are accepted by
+    // AcceptBlockHeader with a lookup. Skip the leading run of them, so that
+    // known headers, which are sent again or announced by several peers,
+    // are not hashed for their proof of work.
+    size_t nKnown = 0;
+    {
+        LOCK(cs_main);
+        while (nKnown < headers.size() && LookupBlockIndex(headers[nKnown].GetHash())) {
+            ++nKnown;
+        }
+    }
+
+    // The context-free checks, in particular hashing the header for its proof
+    // of work, don't need cs_main. Run them for the unknown headers up front,
+    // so that cs_main is only held while the headers are added to
+    // mapBlockIndex. A header that fails them can't be in mapBlockIndex
+    // already, so the headers before it can be accepted as usual.
+    CValidationState stateCheck;
+    const size_t nChecked = CheckBlockHeaders(headers, nKnown, stateCheck, chainparams.GetConsensus());
+
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i = 0; i < nChecked; ++i) {
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
-            if (!g_chainstate.AcceptBlockHeader(header, state, chainparams, &pindex)) {
-                if (first_invalid) *first_invalid = header;
+            if (!g_chainstate.AcceptBlockHeader(headers[i], state, chainparams, &pindex, false)) {
+                if (first_invalid) *first_invalid = headers[i];
                 return false;
             }
             if (ppindex) {
                 *ppindex = pindex;
             }
         }
+        if (nChecked < headers.size()) {
+            state = stateCheck;
+            if (first_invalid) *first_invalid = headers[nChecked];
+            return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, headers[nChecked].GetHash().ToString(), FormatStateMessage(state));
+        }
     }
     NotifyHeaderTip();
     return true;
@@ -3823,9 +3933,11 @@ void PruneOneBlockFile(const int fileNumber)
 {
     LOCK(cs_LastBlockFile);
 
-    for (const auto& entry : mapBlockIndex) {
-        CBlockIndex* pindex = entry.second;
-        if (pindex->nFile == fileNumber) {
+    if ((unsigned int)fileNumber < vBlocksInFile.size()) {
+        for (CBlockIndex* pindex : vBlocksInFile[fileNumber]) {
+            // Skip entries, whose data was erased or stored in another file since
+            if (pindex->nFile != fileNumber) continue;
+
             pindex->nStatus &= ~BLOCK_HAVE_DATA;
             pindex->nStatus &= ~BLOCK_HAVE_UNDO;
             pindex->nFile = 0;
@@ -3846,6 +3958,7 @@ void PruneOneBlockFile(const int fileNumber)
                 }
             }
         }
+        std::vector<CBlockIndex*>().swap(vBlocksInFile[fileNumber]);
     }
 
     vinfoBlockFile[fileNumber].SetNull();
@@ -4079,6 +4192,10 @@ bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlo
             pindex->BuildSkip();
         if (pindex->IsValid(BLOCK_VALID_TREE) && (pindexBestHeader == nullptr || CBlockIndexWorkComparator()(pindexBestHeader, pindex)))
             pindexBestHeader = pindex;
+        setBlockIndexLeaves.insert(pindex);
+    }
+    for (const std::pair<int, CBlockIndex*>& item : vSortedByHeight) {
+        setBlockIndexLeaves.erase(item.second->pprev);
     }
 
     return true;
@@ -4112,7 +4229,7 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams) EXCLUSIVE_LOCKS_RE
     else
          LogPrintf("LoadBlockIndexDB(): synchronized checkpoint %s\n", hashSyncCheckpoint.ToString().c_str());
 
-    // Check presence of blk files
+    // Check presence of blk files, and index the blocks by file
     LogPrintf("Checking all blk files are present...\n");
     std::set<int> setBlkDataFiles;
     for (const std::pair<const uint256, CBlockIndex*>& item : mapBlockIndex)
@@ -4121,6 +4238,12 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams) EXCLUSIVE_LOCKS_RE
         if (pindex->nStatus & BLOCK_HAVE_DATA) {
             setBlkDataFiles.insert(pindex->nFile);
         }
+        if (pindex->nStatus & (BLOCK_HAVE_DATA | BLOCK_HAVE_UNDO)) {
+            if (vBlocksInFile.size() <= (unsigned int)pindex->nFile) {
+                vBlocksInFile.resize(pindex->nFile + 1);
+            }
+            vBlocksInFile[pindex->nFile].push_back(pindex);
+        }
     }
     for (std::set<int>::iterator it = setBlkDataFiles.begin(); it != setBlkDataFiles.end(); it++)
     {
@@ -4532,6 +4655,7 @@ void CChainState::UnloadBlockIndex() {
     nBlockSequenceId = 1;
     m_failed_blocks.clear();
     setBlockIndexCandidates.clear();
+    setBlockIndexLeaves.clear();
 }
 
 // May NOT be used after any connections are up as much
@@ -4546,6 +4670,7 @@ void UnloadBlockIndex()
     mempool.clear();
     mapBlocksUnlinked.clear();
     vinfoBlockFile.clear();
+    vBlocksInFile.clear();
     nLastBlockFile = 0;
     setDirtyBlockIndex.clear();
     setDirtyFileInfo.clear();
@@ -4559,6 +4684,7 @@ void UnloadBlockIndex()
     }
     mapBlockIndex.clear();
     fHavePruned = false;
+    g_block_cache.Clear();
 
     g_chainstate.UnloadBlockIndex();
 }
@@ -4792,6 +4918,10 @@ void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
         if (pindex->pprev != nullptr && pindexFirstNotScriptsValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_SCRIPTS) pindexFirstNotScriptsValid = pindex;
 
         // Begin: actual consistency checks.
+        // The leaves are exactly the blocks, which no other block builds on.
+        assert(setBlockIndexLeaves.count(pindex) == (forward.count(pindex) == 0));
+        // The active chain contains no invalid blocks.
+        if (chainActive.Contains(pindex)) assert((pindex->nStatus & BLOCK_FAILED_MASK) == 0);
         if (pindex->pprev == nullptr) {
             // Genesis block checks.
             assert(pindex->GetBlockHash() == consensusParams.hashGenesisBlock); // Genesis block's hash must match.
@@ -628,15 +628,15 @@ static UniValue getreceivedbyaddress(const JSONRPCRequest& request)
 
     // Tally
     CAmount nAmount = 0;
-    for (const std::pair<const uint256, CWalletTx>& pairWtx : pwallet->mapWallet) {
-        const CWalletTx& wtx = pairWtx.second;
+    for (const auto& output : pwallet->GetTxOutsByDestination(dest)) {
+        const CWalletTx& wtx = *output.first;
+        const CTxOut& txout = wtx.tx->vout[output.second];
         if (wtx.IsCoinBase() || !CheckFinalTx(*wtx.tx))
             continue;
 
-        for (const CTxOut& txout : wtx.tx->vout)
-            if (txout.scriptPubKey == scriptPubKey)
-                if (wtx.GetDepthInMainChain(*locked_chain) >= nMinDepth)
-                    nAmount += txout.nValue;
+        if (txout.scriptPubKey == scriptPubKey)
+            if (wtx.GetDepthInMainChain(*locked_chain) >= nMinDepth)
+                nAmount += txout.nValue;
     }
 
     return  ValueFromAmount(nAmount);
@@ -694,18 +694,17 @@ static UniValue getreceivedbylabel(const JSONRPCRequest& request)
 
     // Tally
     CAmount nAmount = 0;
-    for (const std::pair<const uint256, CWalletTx>& pairWtx : pwallet->mapWallet) {
-        const CWalletTx& wtx = pairWtx.second;
-        if (wtx.IsCoinBase() || !CheckFinalTx(*wtx.tx))
+    for (const CTxDestination& address : setAddress) {
+        if (!IsMine(*pwallet, address))
             continue;
 
-        for (const CTxOut& txout : wtx.tx->vout)
-        {
-            CTxDestination address;
-            if (ExtractDestination(txout.scriptPubKey, address) && IsMine(*pwallet, address) && setAddress.count(address)) {
-                if (wtx.GetDepthInMainChain(*locked_chain) >= nMinDepth)
-                    nAmount += txout.nValue;
-            }
+        for (const auto& output : pwallet->GetTxOutsByDestination(address)) {
+            const CWalletTx& wtx = *output.first;
+            if (wtx.IsCoinBase() || !CheckFinalTx(*wtx.tx))
+                continue;
+
+            if (wtx.GetDepthInMainChain(*locked_chain) >= nMinDepth)
+                nAmount += wtx.tx->vout[output.second].nValue;
         }
     }
 
@@ -1628,11 +1627,14 @@ static UniValue listsinceblock(const JSONRPCRequest& request)
 
     UniValue transactions(UniValue::VARR);
 
-    for (const std::pair<const uint256, CWalletTx>& pairWtx : pwallet->mapWallet) {
-        CWalletTx tx = pairWtx.second;
-
-        if (depth == -1 || tx.GetDepthInMainChain(*locked_chain) < depth) {
-            ListTransactions(*locked_chain, pwallet, tx, 0, true, transactions, filter, nullptr /* filter_label */);
+    if (depth == -1) {
+        for (const std::pair<const uint256, CWalletTx>& pairWtx : pwallet->mapWallet) {
+            ListTransactions(*locked_chain, pwallet, pairWtx.second, 0, true, transactions, filter, nullptr /* filter_label */);
+        }
+    } else {
+        // Only visit the transactions confirmed after the given block, or not at all
+        for (const CWalletTx* pwtx : pwallet->GetTransactionsSince(*locked_chain, *height)) {
+            ListTransactions(*locked_chain, pwallet, *pwtx, 0, true, transactions, filter, nullptr /* filter_label */);
         }
     }
 
@@ -944,8 +944,10 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
         wtx.nTimeReceived = GetAdjustedTime();
         wtx.nOrderPos = IncOrderPosNext(&batch);
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
+        wtx.m_in_block_index = false;
         wtx.nTimeSmart = ComputeTimeSmart(wtx);
         AddToSpends(hash);
+        AddToTxOutsByDestination(wtx);
     }
 
     bool fUpdated = false;
@@ -984,6 +986,8 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
         }
     }
 
+    UpdateTxBlockIndex(wtx);
+
     //// debug print
     WalletLogPrintf("AddToWallet %s  %s%s\n", wtxIn.GetHash().ToString(), (fInsertedNew ? "new" : ""), (fUpdated ? "update" : ""));
 
@@ -1019,7 +1023,10 @@ void CWallet::LoadToWallet(const CWalletTx& wtxIn)
     wtx.BindWallet(this);
     if (/* insertion took place */ ins.second) {
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
+        wtx.m_in_block_index = false;
+        AddToTxOutsByDestination(wtx);
     }
+    UpdateTxBlockIndex(wtx);
     AddToSpends(hash);
     for (const CTxIn& txin : wtx.tx->vin) {
         auto it = mapWallet.find(txin.prevout.hash);
@@ -1107,6 +1114,133 @@ void CWallet::MarkInputsDirty(const CTransactionRef& tx)
     }
 }
 
+void CWallet::UpdateTxBlockIndex(CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+
+    // Conflicted and abandoned transactions carry the hash of a block too, but have no position in it
+    const bool fConfirmed = !wtx.hashUnset() && wtx.nIndex != -1 && !setDisconnectedBlocks.count(wtx.hashBlock);
+    if (fConfirmed && wtx.m_in_block_index && wtx.m_it_tx_by_block->first == wtx.hashBlock) {
+        return;
+    }
+
+    RemoveTxBlockIndex(wtx);
+    if (fConfirmed) {
+        wtx.m_it_tx_by_block = mapTxByBlock.emplace(wtx.hashBlock, &wtx);
+        wtx.m_in_block_index = true;
+    } else {
+        setTxUnconfirmed.insert(&wtx);
+    }
+}
+
+void CWallet::RemoveTxBlockIndex(CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+
+    if (wtx.m_in_block_index) {
+        mapTxByBlock.erase(wtx.m_it_tx_by_block);
+        wtx.m_in_block_index = false;
+    } else {
+        setTxUnconfirmed.erase(&wtx);
+    }
+}
+
+void CWallet::AddToTxOutsByDestination(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); ++i) {
+        CTxDestination dest;
+        if (ExtractDestination(wtx.tx->vout[i].scriptPubKey, dest)) {
+            mapTxOutsByDestination.emplace(dest, std::make_pair(&wtx, i));
+        }
+    }
+}
+
+void CWallet::RemoveFromTxOutsByDestination(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+
+    for (const CTxOut& txout : wtx.tx->vout) {
+        CTxDestination dest;
+        if (!ExtractDestination(txout.scriptPubKey, dest)) continue;
+        auto range = mapTxOutsByDestination.equal_range(dest);
+        for (auto it = range.first; it != range.second;) {
+            if (it->second.first == &wtx) {
+                it = mapTxOutsByDestination.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+std::vector<std::pair<const CWalletTx*, unsigned int>> CWallet::GetTxOutsByDestination(const CTxDestination& dest) const
+{
+    AssertLockHeld(cs_wallet);
+
+    std::vector<std::pair<const CWalletTx*, unsigned int>> outputs;
+    auto range = mapTxOutsByDestination.equal_range(dest);
+    for (auto it = range.first; it != range.second; ++it) {
+        outputs.push_back(it->second);
+    }
+    return outputs;
+}
+
+void CWallet::MarkDisconnectedBlocks(interfaces::Chain::Lock& locked_chain)
+{
+    AssertLockHeld(cs_wallet);
+
+    std::vector<CWalletTx*> vStale;
+    for (auto it = mapTxByBlock.begin(); it != mapTxByBlock.end(); it = mapTxByBlock.upper_bound(it->first)) {
+        if (!locked_chain.getBlockHeight(it->first)) {
+            setDisconnectedBlocks.insert(it->first);
+            auto range = mapTxByBlock.equal_range(it->first);
+            for (auto itTx = range.first; itTx != range.second; ++itTx) {
+                vStale.push_back(itTx->second);
+            }
+        }
+    }
+    for (CWalletTx* pwtx : vStale) {
+        UpdateTxBlockIndex(*pwtx);
+    }
+}
+
+std::vector<const CWalletTx*> CWallet::GetTransactionsSince(interfaces::Chain::Lock& locked_chain, int height) const
+{
+    AssertLockHeld(cs_wallet);
+
+    std::vector<const CWalletTx*> vResult;
+    const Optional<int> tip_height = locked_chain.getHeight();
+    if (!tip_height) {
+        return vResult;
+    }
+
+    if (m_last_block_processed != locked_chain.getBlockHash(*tip_height)) {
+        // The index reflects the blocks seen by the wallet, so scan all
+        // transactions, if the wallet has not caught up with the chain
+        const int depth = 1 + *tip_height - height;
+        for (const std::pair<const uint256, CWalletTx>& pairWtx : mapWallet) {
+            if (pairWtx.second.GetDepthInMainChain(locked_chain) < depth) {
+                vResult.push_back(&pairWtx.second);
+            }
+        }
+        return vResult;
+    }
+
+    vResult.assign(setTxUnconfirmed.begin(), setTxUnconfirmed.end());
+    for (int nHeight = std::max(height + 1, 0); nHeight <= *tip_height; ++nHeight) {
+        auto range = mapTxByBlock.equal_range(locked_chain.getBlockHash(nHeight));
+        for (auto it = range.first; it != range.second; ++it) {
+            vResult.push_back(it->second);
+        }
+    }
+    std::sort(vResult.begin(), vResult.end(), [](const CWalletTx* a, const CWalletTx* b) {
+        return a->GetHash() < b->GetHash();
+    });
+    return vResult;
+}
+
 bool CWallet::AbandonTransaction(interfaces::Chain::Lock& locked_chain, const uint256& hashTx)
 {
     auto locked_chain_recursive = chain().lock();  // Temporary. Removed in upcoming lock cleanup
@@ -1144,6 +1278,7 @@ bool CWallet::AbandonTransaction(interfaces::Chain::Lock& locked_chain, const ui
             wtx.nIndex = -1;
             wtx.setAbandoned();
             wtx.MarkDirty();
+            UpdateTxBlockIndex(wtx);
             batch.WriteTx(wtx);
             NotifyTransactionChanged(this, wtx.GetHash(), CT_UPDATED);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them abandoned too
@@ -1198,6 +1333,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, const uint256& hashTx)
             wtx.nIndex = -1;
             wtx.hashBlock = hashBlock;
             wtx.MarkDirty();
+            UpdateTxBlockIndex(wtx);
             batch.WriteTx(wtx);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
             TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
@@ -1254,6 +1390,8 @@ void CWallet::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const
     // to abandon a transaction and then have it inadvertently cleared by
     // the notification that the conflicted transaction was evicted.
 
+    setDisconnectedBlocks.erase(pindex->GetBlockHash());
+
     for (const CTransactionRef& ptx : vtxConflicted) {
         SyncTransaction(ptx, {} /* block hash */, 0 /* position in block */);
         TransactionRemovedFromMempool(ptx);
@@ -1270,6 +1408,18 @@ void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
     auto locked_chain = chain().lock();
     LOCK(cs_wallet);
 
+    // Transactions keep the hash of the disconnected block, but are no longer confirmed
+    const uint256 hashBlock = pblock->GetHash();
+    setDisconnectedBlocks.insert(hashBlock);
+    std::vector<CWalletTx*> vDisconnected;
+    auto range = mapTxByBlock.equal_range(hashBlock);
+    for (auto it = range.first; it != range.second; ++it) {
+        vDisconnected.push_back(it->second);
+    }
+    for (CWalletTx* pwtx : vDisconnected) {
+        UpdateTxBlockIndex(*pwtx);
+    }
+
     for (const CTransactionRef& ptx : pblock->vtx) {
         SyncTransaction(ptx, {} /* block hash */, 0 /* position in block */);
     }
@@ -2130,13 +2280,27 @@ std::vector<uint256> CWallet::ResendWalletTransactionsBefore(interfaces::Chain::
 
     // Sort them in chronological order
     std::multimap<unsigned int, CWalletTx*> mapSorted;
-    for (std::pair<const uint256, CWalletTx>& item : mapWallet)
-    {
-        CWalletTx& wtx = item.second;
-        // Don't rebroadcast if newer than nTime:
-        if (wtx.nTimeReceived > nTime)
-            continue;
-        mapSorted.insert(std::make_pair(wtx.nTimeReceived, &wtx));
+    const Optional<int> tip_height = locked_chain.getHeight();
+    if (tip_height && m_last_block_processed == locked_chain.getBlockHash(*tip_height)) {
+        // Only transactions, which are not confirmed in the main chain, can
+        // be relayed, and the wallet keeps them in setTxUnconfirmed
+        for (CWalletTx* pwtx : setTxUnconfirmed) {
+            // Don't rebroadcast if newer than nTime, or abandoned:
+            if (pwtx->nTimeReceived > nTime || pwtx->isAbandoned())
+                continue;
+            mapSorted.insert(std::make_pair(pwtx->nTimeReceived, pwtx));
+        }
+    } else {
+        // The index reflects the blocks seen by the wallet, so scan all
+        // transactions, if the wallet has not caught up with the chain
+        for (std::pair<const uint256, CWalletTx>& item : mapWallet)
+        {
+            CWalletTx& wtx = item.second;
+            // Don't rebroadcast if newer than nTime:
+            if (wtx.nTimeReceived > nTime)
+                continue;
+            mapSorted.insert(std::make_pair(wtx.nTimeReceived, &wtx));
+        }
     }
     for (const std::pair<const unsigned int, CWalletTx*>& item : mapSorted)
     {
@@ -3274,6 +3438,8 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
     for (uint256 hash : vHashOut) {
         const auto& it = mapWallet.find(hash);
         wtxOrdered.erase(it->second.m_it_wtxOrdered);
+        RemoveTxBlockIndex(it->second);
+        RemoveFromTxOutsByDestination(it->second);
         mapWallet.erase(it);
     }
 
@@ -4434,6 +4600,11 @@ std::shared_ptr<CWallet> CWallet::CreateWalletFromFile(interfaces::Chain& chain,
         }
     }
 
+    {
+        LOCK(walletInstance->cs_wallet);
+        walletInstance->MarkDisconnectedBlocks(*locked_chain);
+    }
+
     uiInterface.LoadWallet(walletInstance);
 
     // Register with the validation interface. It's ok to do this after rescan since we're still holding cs_main.
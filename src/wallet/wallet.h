@@ -388,6 +388,9 @@ public:
     char fFromMe;
     int64_t nOrderPos; //!< position in ordered transaction list
     std::multimap<int64_t, CWalletTx*>::const_iterator m_it_wtxOrdered;
+    //! Position in CWallet::mapTxByBlock, only valid if m_in_block_index is set
+    std::multimap<uint256, CWalletTx*>::iterator m_it_tx_by_block;
+    bool m_in_block_index = false;
 
     // memory only
     mutable bool fDebitCached;
@@ -691,6 +694,18 @@ private:
     /* Mark a transaction's inputs dirty, thus forcing the outputs to be recomputed */
     void MarkInputsDirty(const CTransactionRef& tx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
+    /* Files a transaction under its block in mapTxByBlock, or in setTxUnconfirmed, if it is not confirmed in the main chain. */
+    void UpdateTxBlockIndex(CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /* Removes a transaction from mapTxByBlock and setTxUnconfirmed. */
+    void RemoveTxBlockIndex(CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /* Files the outputs of a new transaction under their destination in mapTxOutsByDestination. */
+    void AddToTxOutsByDestination(const CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /* Removes the outputs of a transaction from mapTxOutsByDestination. */
+    void RemoveFromTxOutsByDestination(const CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     void SyncMetaData(std::pair<TxSpends::iterator, TxSpends::iterator>) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     /* Used by TransactionAddedToMemorypool/BlockConnected/Disconnected/ScanForWalletTransactions.
@@ -742,6 +757,26 @@ private:
      */
     uint256 m_last_block_processed;
 
+    /**
+     * Index of the transactions by confirmation, used by listsinceblock and
+     * the rebroadcast of unconfirmed transactions to avoid walking all
+     * transactions. Confirmed transactions are filed under
+     * the hash of their block, all others (unconfirmed, conflicted, abandoned
+     * or confirmed in a block which was disconnected) in setTxUnconfirmed.
+     */
+    std::multimap<uint256, CWalletTx*> mapTxByBlock;
+    std::set<CWalletTx*> setTxUnconfirmed;
+    //! Blocks, which were disconnected from the main chain since the wallet was loaded
+    std::set<uint256> setDisconnectedBlocks;
+
+    /**
+     * Outputs of all wallet transactions by destination, as (transaction,
+     * output index), used by getreceivedbyaddress and getreceivedbylabel to
+     * avoid walking all transactions. Outputs without a destination are not
+     * indexed.
+     */
+    std::multimap<CTxDestination, std::pair<const CWalletTx*, unsigned int>> mapTxOutsByDestination;
+
 public:
     /*
      * Main wallet lock.
@@ -922,6 +957,19 @@ public:
     void MarkDirty();
     bool AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose=true);
     void LoadToWallet(const CWalletTx& wtxIn) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /** Moves transactions of blocks, which are not in the main chain, to the unconfirmed transactions. Used after loading the wallet. */
+    void MarkDisconnectedBlocks(interfaces::Chain::Lock& locked_chain) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /**
+     * Returns the transactions, which are not confirmed in the main chain at
+     * or below the given height, ordered by txid. Only the blocks above the
+     * given height are visited, unless the wallet lags behind the chain.
+     */
+    std::vector<const CWalletTx*> GetTransactionsSince(interfaces::Chain::Lock& locked_chain, int height) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /** Returns the wallet transaction outputs, which pay to the destination, as (transaction, output index). */
+    std::vector<std::pair<const CWalletTx*, unsigned int>> GetTxOutsByDestination(const CTxDestination& dest) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     void TransactionAddedToMempool(const CTransactionRef& tx) override;
     void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex *pindex, const std::vector<CTransactionRef>& vtxConflicted) override;
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) override;
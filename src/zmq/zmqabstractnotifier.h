@@ -7,6 +7,7 @@
 
 #include <zmq/zmqconfig.h>
 
+class CBlock;
 class CBlockIndex;
 class CZMQAbstractNotifier;
 
@@ -40,7 +41,7 @@ public:
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
 
-    virtual bool NotifyBlock(const CBlockIndex *pindex);
+    virtual bool NotifyBlock(const CBlockIndex *pindex, const CBlock &block);
     virtual bool NotifyTransaction(const CTransaction &transaction);
 
 protected:
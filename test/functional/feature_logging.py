@@ -8,6 +8,7 @@ import os
 
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.test_node import ErrorMatch
+from test_framework.util import assert_equal
 
 
 class LoggingTest(BitcoinTestFramework):
@@ -70,6 +71,24 @@ class LoggingTest(BitcoinTestFramework):
         self.stop_node(0)
         self.start_node(0, ["-debuglogfile=%s" % os.devnull])
 
+        # check that the background writer writes all messages up to shutdown
+        self.stop_node(0)
+        self.start_node(0, ["-logqueuesize=10000", "-debug=1"])
+        self.nodes[0].generatetoaddress(10, self.nodes[0].get_deterministic_priv_key().address)
+        self.stop_node(0)
+        with open(default_log_path, encoding='utf-8') as f:
+            log = f.read()
+        assert_equal(log.count("UpdateTip: new best="), 10)
+        assert "Dropped" not in log
+        assert log.rstrip().endswith("Shutdown: done")
+
+        # messages, which do not fit into the queue, are counted
+        os.unlink(default_log_path)
+        self.start_node(0, ["-logqueuesize=1", "-debug=1"])
+        self.nodes[0].generatetoaddress(10, self.nodes[0].get_deterministic_priv_key().address)
+        self.stop_node(0)
+        with open(default_log_path, encoding='utf-8') as f:
+            assert "log messages, as the log queue was full" in f.read()
 
 if __name__ == '__main__':
     LoggingTest().main()
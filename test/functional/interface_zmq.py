@@ -11,6 +11,8 @@ from test_framework.messages import CTransaction
 from test_framework.util import (
     assert_equal,
     bytes_to_hex_str,
+    connect_nodes,
+    disconnect_nodes,
     hash256,
 )
 from io import BytesIO
@@ -79,13 +81,8 @@ class ZMQTest (BitcoinTestFramework):
             self.log.debug("Destroying ZMQ context")
             self.zmq_context.destroy(linger=None)
 
-    def _zmq_test(self):
-        num_blocks = 5
-        self.log.info("Generate %(n)d blocks (and %(n)d coinbase txes)" % {"n": num_blocks})
-        genhashes = self.nodes[0].generatetoaddress(num_blocks, ADDRESS_BCRT1_UNSPENDABLE)
-        self.sync_all()
-
-        for x in range(num_blocks):
+    def _receive_blocks(self, genhashes):
+        for x in range(len(genhashes)):
             # Should receive the coinbase txid.
             txid = self.hashtx.receive()
 
@@ -106,6 +103,27 @@ class ZMQTest (BitcoinTestFramework):
             block = self.rawblock.receive()
             assert_equal(genhashes[x], bytes_to_hex_str(hash256(block[:80])))
 
+    def _zmq_test(self):
+        num_blocks = 5
+        self.log.info("Generate %(n)d blocks (and %(n)d coinbase txes)" % {"n": num_blocks})
+        genhashes = self.nodes[0].generatetoaddress(num_blocks, ADDRESS_BCRT1_UNSPENDABLE)
+        self.sync_all()
+        self._receive_blocks(genhashes)
+
+        self.log.info("Connect %d blocks at once and check that every block is published in order" % num_blocks)
+        disconnect_nodes(self.nodes[0], 1)
+        genhashes = self.nodes[1].generatetoaddress(num_blocks, ADDRESS_BCRT1_UNSPENDABLE)
+        for hash in genhashes:
+            self.nodes[0].submitheader(self.nodes[1].getblockheader(hash, False))
+        # The blocks can only be connected once the first block of the chain is
+        # submitted last, which then connects all of them in one go.
+        for hash in reversed(genhashes):
+            self.nodes[0].submitblock(self.nodes[1].getblock(hash, 0))
+        assert_equal(self.nodes[0].getbestblockhash(), genhashes[-1])
+        connect_nodes(self.nodes[0], 1)
+        self.sync_all()
+        self._receive_blocks(genhashes)
+
         if self.is_wallet_compiled():
             self.log.info("Wait for tx from second node")
             payment_txid = self.nodes[1].sendtoaddress(self.nodes[0].getnewaddress(), 1.0)
@@ -56,6 +56,20 @@ class MempoolPackagesTest(BitcoinTestFramework):
         # count and fees should look correct
         mempool = self.nodes[0].getrawmempool(True)
         assert_equal(len(mempool), MAX_ANCESTORS)
+
+        # Check that paging through the mempool by txid returns the same entries
+        paged = {}
+        start = ""
+        while True:
+            page = self.nodes[0].getrawmempool(True, start, 7)
+            assert_equal(list(page.keys()), sorted(page.keys()))
+            paged.update(page)
+            if len(page) < 7:
+                break
+            start = list(page.keys())[-1]
+        assert_equal(paged, mempool)
+        assert_equal(self.nodes[0].getrawmempool(False, "", 5), sorted(mempool.keys())[:5])
+
         descendant_count = 1
         descendant_fees = 0
         descendant_size = 0
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+# Copyright (c) 2019 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the multithreaded nonce search of the generate RPCs.
+
+Two nodes with a different number of threads (-par) mine the same chain
+in isolation. As the lowest valid nonce is always chosen, the block hashes
+must not depend on the number of threads."""
+
+import time
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+ADDRESS = "mrCDrCybB6J1vRfbwM5hemdJz73FwDBC8r"
+NUM_BLOCKS = 1000
+
+
+class GenerateParTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.setup_clean_chain = True
+        self.extra_args = [["-par=1"], ["-par=4"]]
+
+    def setup_network(self):
+        # The nodes must not share their blocks
+        self.setup_nodes()
+
+    def run_test(self):
+        mocktime = int(time.time())
+        for node in self.nodes:
+            node.setmocktime(mocktime)
+
+        self.log.info("Mine %d blocks with -par=1" % NUM_BLOCKS)
+        start = time.time()
+        hashes_single = self.nodes[0].generatetoaddress(NUM_BLOCKS, ADDRESS)
+        elapsed_single = time.time() - start
+
+        self.log.info("Mine %d blocks with -par=4" % NUM_BLOCKS)
+        start = time.time()
+        hashes_par = self.nodes[1].generatetoaddress(NUM_BLOCKS, ADDRESS)
+        elapsed_par = time.time() - start
+
+        self.log.info("Mined %d blocks in %.2fs with -par=1 and in %.2fs with -par=4" % (NUM_BLOCKS, elapsed_single, elapsed_par))
+        assert_equal(len(hashes_par), NUM_BLOCKS)
+        assert_equal(hashes_single, hashes_par)
+
+        self.log.info("Check that maxtries is still honored")
+        assert_equal(self.nodes[1].generatetoaddress(1, ADDRESS, 0), [])
+        assert_equal(self.nodes[1].getblockcount(), NUM_BLOCKS)
+
+
+if __name__ == '__main__':
+    GenerateParTest().main()
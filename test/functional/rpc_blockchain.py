@@ -58,6 +58,7 @@ class BlockchainTest(BitcoinTestFramework):
         self._test_getchaintxstats()
         self._test_gettxoutsetinfo()
         self._test_getblockheader()
+        self._test_getblockcacheinfo()
         self._test_getdifficulty()
         self._test_getnetworkhashps()
         self._test_stopatheight()
@@ -214,6 +215,28 @@ class BlockchainTest(BitcoinTestFramework):
         del res['disk_size'], res3['disk_size']
         assert_equal(res, res3)
 
+        self.log.info("Test that gettxoutsetinfo() with hash_type muhash and none agrees with the full scan")
+        res4 = node.gettxoutsetinfo("muhash")
+        assert_equal(len(res4['muhash']), 64)
+        assert 'hash_serialized_2' not in res4
+        assert 'transactions' not in res4
+        for field in ['height', 'bestblock', 'txouts', 'bogosize', 'total_amount']:
+            assert_equal(res4[field], res3[field])
+
+        res5 = node.gettxoutsetinfo(hash_type="none")
+        assert 'muhash' not in res5
+        assert 'hash_serialized_2' not in res5
+        del res4['muhash'], res4['disk_size'], res5['disk_size']
+        assert_equal(res4, res5)
+
+        self.log.info("Test that the muhash is restored after invalidate/reconsider block")
+        muhash = node.gettxoutsetinfo("muhash")['muhash']
+        node.invalidateblock(b1hash)
+        assert_equal(node.gettxoutsetinfo("muhash")['txouts'], 0)
+        node.reconsiderblock(b1hash)
+        assert_equal(node.gettxoutsetinfo("muhash")['muhash'], muhash)
+        assert_raises_rpc_error(-8, "foo is not a valid hash_type", node.gettxoutsetinfo, "foo")
+
     def _test_getblockheader(self):
         node = self.nodes[0]
 
@@ -242,6 +265,21 @@ class BlockchainTest(BitcoinTestFramework):
         assert isinstance(int(header['versionHex'], 16), int)
         assert isinstance(header['difficulty'], Decimal)
 
+    def _test_getblockcacheinfo(self):
+        node = self.nodes[0]
+
+        assert_equal(node.getblockcacheinfo()['maxsize'], 10)
+
+        # A freshly connected block is served from the cache
+        besthash = node.getbestblockhash()
+        node.invalidateblock(besthash)
+        node.reconsiderblock(besthash)
+        hits = node.getblockcacheinfo()['hits']
+        node.getblock(besthash)
+        info = node.getblockcacheinfo()
+        assert_greater_than(info['size'], 0)
+        assert_equal(info['hits'], hits + 1)
+
     def _test_getdifficulty(self):
         difficulty = self.nodes[0].getdifficulty()
         # 1 hash in 2 should be valid, so difficulty should be 1/2**31
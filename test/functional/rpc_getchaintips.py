@@ -58,5 +58,10 @@ class GetChainTipsTest (BitcoinTestFramework):
         tips[1]['status'] = 'active'
         assert_equal (tips[1], shortTip)
 
+        # The tips are the same after the block index is loaded from disk
+        tips = self.nodes[0].getchaintips ()
+        self.restart_node (0)
+        assert_equal (self.nodes[0].getchaintips (), tips)
+
 if __name__ == '__main__':
     GetChainTipsTest ().main ()
@@ -10,6 +10,8 @@ Test the following RPCs:
    - sendrawtransaction
    - decoderawtransaction
    - getrawtransaction
+   - getrawtransactions
+   - gettxouts
 """
 
 from collections import OrderedDict
@@ -232,6 +234,35 @@ class RawTransactionsTest(BitcoinTestFramework):
         self.nodes[0].reconsiderblock(block1)
         assert_equal(self.nodes[0].getbestblockhash(), block2)
 
+        ####################################
+        # getrawtransactions and gettxouts #
+        ####################################
+
+        coinbase1 = self.nodes[0].getblock(block1)['tx'][0]
+        coinbase2 = self.nodes[0].getblock(block2)['tx'][0]
+        unknown = "00" * 32
+        gottxs = self.nodes[0].getrawtransactions([coinbase2, tx, unknown, coinbase1])
+        assert_equal([e['txid'] for e in gottxs], [coinbase2, tx, unknown, coinbase1])
+        for e in [gottxs[0], gottxs[1], gottxs[3]]:
+            assert_equal(e['hex'], self.nodes[0].getrawtransaction(e['txid']))
+        assert_equal(gottxs[2]['error']['code'], -5)
+        assert_equal(gottxs[2]['error']['message'], "No such mempool or blockchain transaction. Use gettransaction for wallet transactions.")
+        gottxs = self.nodes[0].getrawtransactions([tx, coinbase2], True, block1)
+        assert_equal(gottxs[0]['blockhash'], block1)
+        assert_equal(gottxs[0]['in_active_chain'], True)
+        assert_equal(gottxs[1]['error']['message'], "No such transaction found in the provided block")
+        assert_raises_rpc_error(-5, "Block hash not found", self.nodes[0].getrawtransactions, [tx], True, unknown)
+
+        outpoints = [{'txid': coinbase1, 'vout': 0}, {'txid': unknown, 'vout': 0}, {'txid': tx, 'vout': 0}]
+        gotouts = self.nodes[0].gettxouts(outpoints)
+        assert_equal(gotouts[1], None)
+        for outpoint, e in zip(outpoints, gotouts):
+            if e is not None:
+                assert_equal((e['txid'], e['vout']), (outpoint['txid'], outpoint['vout']))
+                del e['txid'], e['vout']
+            assert_equal(e, self.nodes[0].gettxout(outpoint['txid'], outpoint['vout']))
+        assert_raises_rpc_error(-8, "Invalid parameter, vout must be positive", self.nodes[0].gettxouts, [{'txid': tx, 'vout': -1}])
+
         #########################
         # RAW TX MULTISIG TESTS #
         #########################
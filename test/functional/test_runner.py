@@ -193,6 +193,7 @@ BASE_SCRIPTS = [
     #'feature_help.py',
     #'feature_shutdown.py',
     'omni_reorg.py',
+    'mining_generate_par.py',
     'omni_clientexpiry.py',
     'omni_stov1.py',
     'omni_freeze.py',
@@ -166,5 +166,10 @@ class ReceivedByTest(BitcoinTestFramework):
         balance = self.nodes[1].getreceivedbylabel("mynewlabel")
         assert_equal(balance, Decimal("0.0"))
 
+        self.log.info("getreceivedbyaddress + getreceivedbylabel after reloading the wallet")
+        self.restart_node(1)
+        assert_equal(self.nodes[1].getreceivedbyaddress(addr), Decimal("0.2"))
+        assert_equal(self.nodes[1].getreceivedbylabel(label), balance_by_label + Decimal("0.1"))
+
 if __name__ == '__main__':
     ReceivedByTest().main()
@@ -24,6 +24,7 @@ class ListSinceBlockTest (BitcoinTestFramework):
         self.test_reorg()
         self.test_double_spend()
         self.test_double_send()
+        self.test_disconnected_block()
 
     def test_no_blockhash(self):
         txid = self.nodes[2].sendtoaddress(self.nodes[0].getnewaddress(), 1)
@@ -281,5 +282,35 @@ class ListSinceBlockTest (BitcoinTestFramework):
             if tx['txid'] == txid1:
                 assert_equal(tx['confirmations'], 2)
 
+    def test_disconnected_block(self):
+        '''
+        Transactions of a block, which is disconnected without being replaced,
+        have no confirmations, and must be listed since any earlier block.
+        '''
+
+        self.sync_all()
+
+        txid = self.nodes[2].sendtoaddress(self.nodes[0].getnewaddress(), 1)
+        self.sync_all()
+        blockhash = self.nodes[2].generate(1)[0]
+        self.sync_all()
+        parenthash = self.nodes[0].getblockheader(blockhash)['previousblockhash']
+
+        assert any(tx['txid'] == txid for tx in self.nodes[0].listsinceblock(parenthash)['transactions'])
+        assert not any(tx['txid'] == txid for tx in self.nodes[0].listsinceblock(blockhash)['transactions'])
+
+        self.nodes[0].invalidateblock(blockhash)
+        grandparenthash = self.nodes[0].getblockheader(parenthash)['previousblockhash']
+        lsbres = self.nodes[0].listsinceblock(grandparenthash)
+        assert_array_result(lsbres['transactions'], {"txid": txid}, {"confirmations": 0})
+        lsbres = self.nodes[0].listsinceblock(parenthash)
+        assert_array_result(lsbres['transactions'], {"txid": txid}, {"confirmations": 0})
+
+        self.nodes[0].reconsiderblock(blockhash)
+        self.sync_all()
+        assert not any(tx['txid'] == txid for tx in self.nodes[0].listsinceblock(blockhash)['transactions'])
+        lsbres = self.nodes[0].listsinceblock(parenthash)
+        assert_array_result(lsbres['transactions'], {"txid": txid}, {"confirmations": 1})
+
 if __name__ == '__main__':
     ListSinceBlockTest().main()